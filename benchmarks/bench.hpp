@@ -3,10 +3,19 @@
  * * SPDX-License-Identifier: BSD-3-Clause
  * *******************************************/
 
+#include "avx2-32bit-qsort.hpp"
+#include "avx2-64bit-qsort.hpp"
 #include "avx512-16bit-qsort.hpp"
+#include "avx512-batched-sort.hpp"
+#include "avx512-32bit-keyvaluesort.hpp"
 #include "avx512-32bit-qsort.hpp"
+#include "avx512-64bit-argsort.hpp"
 #include "avx512-64bit-keyvaluesort.hpp"
 #include "avx512-64bit-qsort.hpp"
+#include "avx512-parallel-qsort.hpp"
+#include "avx512-radix-sort.hpp"
+#include "avx512-ymm-qsort.hpp"
+#include <chrono>
 #include <iostream>
 #include <numeric>
 #include <tuple>
@@ -80,6 +89,319 @@ std::tuple<uint64_t, uint64_t> bench_sort(const std::vector<T> arr,
     return std::make_tuple(avx_sort, std_sort);
 }
 
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_sort_desc(const std::vector<T> arr,
+                                               const uint64_t iters,
+                                               const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_qsort_desc<T>(arr_bckup.data(), arr_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::sort(arr_bckup.begin(), arr_bckup.end(), std::greater<T>());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+template <typename T>
+std::tuple<uint64_t, uint64_t>
+bench_sort_parallel(const std::vector<T> arr,
+                    void (*sort)(T *, int64_t, int),
+                    const int nthreads,
+                    const uint64_t iters,
+                    const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        sort(arr_bckup.data(), arr_bckup.size(), nthreads);
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::sort(arr_bckup.begin(), arr_bckup.end());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+/*
+ * Compares sort (avx512_radix_sort or avx512_msd_qsort) against avx512_qsort
+ * instead of std::sort
+ */
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_radix_sort(const std::vector<T> arr,
+                                                void (*sort)(T *, int64_t),
+                                                const uint64_t iters,
+                                                const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        sort(arr_bckup.data(), arr_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t radix_sort = std::accumulate(runtimes1.end() - lastfew,
+                                          runtimes1.end(),
+                                          (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_qsort<T>(arr_bckup.data(), arr_bckup.size());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(radix_sort, avx_sort);
+}
+
+/*
+ * Compares avx512_radix_sort_kv against avx512_qsort_kv
+ */
+template <typename K, typename V>
+std::tuple<uint64_t, uint64_t> bench_radix_sort_kv(const std::vector<K> keys,
+                                                   const std::vector<V> values,
+                                                   const uint64_t iters,
+                                                   const uint64_t lastfew)
+{
+    std::vector<K> keys_bckup = keys;
+    std::vector<V> values_bckup = values;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_radix_sort_kv<K, V>(
+                keys_bckup.data(), values_bckup.data(), keys_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        keys_bckup = keys;
+        values_bckup = values;
+    }
+    uint64_t radix_sort = std::accumulate(runtimes1.end() - lastfew,
+                                          runtimes1.end(),
+                                          (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_qsort_kv<K, V>(
+                keys_bckup.data(), values_bckup.data(), keys_bckup.size());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        keys_bckup = keys;
+        values_bckup = values;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(radix_sort, avx_sort);
+}
+
+template <typename T>
+std::tuple<uint64_t, uint64_t>
+bench_segmented_sort(const std::vector<T> arr,
+                     const std::vector<int64_t> offsets,
+                     const uint64_t iters,
+                     const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    int64_t nsegments = offsets.size() - 1;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_segmented_sort<T>(arr_bckup.data(), offsets.data(), nsegments);
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        for (int64_t jj = 0; jj < nsegments; ++jj) {
+            std::sort(arr_bckup.begin() + offsets[jj],
+                      arr_bckup.begin() + offsets[jj + 1]);
+        }
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+/*
+ * arr holds batchsize arrays of arrsize elements, stored transposed for
+ * avx512_batched_sort. std::sort gets the same arrays stored one after the
+ * other.
+ */
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_batched_sort(const std::vector<T> arr,
+                                                  const int32_t arrsize,
+                                                  const uint64_t iters,
+                                                  const uint64_t lastfew)
+{
+    int64_t batchsize = arr.size() / arrsize;
+    std::vector<T> arr_bckup = arr;
+    std::vector<T> rows(arr.size());
+    for (int64_t jj = 0; jj < batchsize; ++jj) {
+        for (int32_t ii = 0; ii < arrsize; ++ii) {
+            rows[jj * arrsize + ii] = arr[ii * batchsize + jj];
+        }
+    }
+    std::vector<T> rows_bckup = rows;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_batched_sort<T>(arr_bckup.data(), arrsize, batchsize);
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        for (int64_t jj = 0; jj < batchsize; ++jj) {
+            std::sort(rows_bckup.begin() + jj * arrsize,
+                      rows_bckup.begin() + (jj + 1) * arrsize);
+        }
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        rows_bckup = rows;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_partial_sort(const std::vector<T> arr,
+                                                  const int64_t k,
+                                                  const uint64_t iters,
+                                                  const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_partial_qsort<T>(arr_bckup.data(), k, arr_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::partial_sort(
+                arr_bckup.begin(), arr_bckup.begin() + k, arr_bckup.end());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_argsort(const std::vector<T> arr,
+                                             const uint64_t iters,
+                                             const uint64_t lastfew)
+{
+    std::vector<int64_t> arg(arr.size());
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_argsort<T>(arr.data(), arg.data(), arr.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::iota(arg.begin(), arg.end(), 0);
+        std_argsort(arr.data(), arg.data(), 0, arr.size());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
 template <typename K, typename V = uint64_t>
 std::tuple<uint64_t, uint64_t>
 bench_sort_kv(const std::vector<K> keys,
@@ -126,3 +448,292 @@ bench_sort_kv(const std::vector<K> keys,
             / lastfew;
     return std::make_tuple(avx_sort, std_sort);
 }
+
+template <typename K, typename V = uint64_t>
+std::tuple<uint64_t, uint64_t>
+bench_stable_sort_kv(const std::vector<K> keys,
+                     const std::vector<V> values,
+                     const std::vector<sorted_t<K, V>> sortedaar,
+                     const uint64_t iters,
+                     const uint64_t lastfew)
+{
+
+    std::vector<K> keys_bckup = keys;
+    std::vector<V> values_bckup = values;
+    std::vector<sorted_t<K, V>> sortedaar_bckup = sortedaar;
+
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_stable_sort_kv(
+                keys_bckup.data(), values_bckup.data(), keys_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        keys_bckup = keys;
+        values_bckup = values;
+    }
+    uint64_t avx_sort = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::stable_sort(sortedaar_bckup.begin(),
+                         sortedaar_bckup.end(),
+                         [](sorted_t<K, V> a, sorted_t<K, V> b) {
+                             return a.key < b.key;
+                         });
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        sortedaar_bckup = sortedaar;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx_sort, std_sort);
+}
+
+/*
+ * Cycles per element of one partition of arr around a random element, with
+ * the unrolled partition_avx512_unrolled and with the one register at a time
+ * partition_avx512
+ */
+template <typename T>
+std::tuple<double, double> bench_partition(const std::vector<T> arr,
+                                           const uint64_t iters,
+                                           const uint64_t lastfew)
+{
+    using vtype = zmm_vector<T>;
+    constexpr int num_unroll = sizeof(T) == 8 ? X86_SIMD_SORT_UNROLL_64BIT
+                                              : X86_SIMD_SORT_UNROLL_32BIT;
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    const T pivot = arr[arr.size() / 2];
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        T smallest = vtype::type_max();
+        T biggest = vtype::type_min();
+        start = cycles_start();
+        partition_avx512_unrolled<vtype, num_unroll>(arr_bckup.data(),
+                                                     0,
+                                                     arr_bckup.size(),
+                                                     pivot,
+                                                     &smallest,
+                                                     &biggest);
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t unrolled = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        T smallest = vtype::type_max();
+        T biggest = vtype::type_min();
+        start = cycles_start();
+        partition_avx512<vtype>(arr_bckup.data(),
+                                0,
+                                arr_bckup.size(),
+                                pivot,
+                                &smallest,
+                                &biggest);
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t one_reg = std::accumulate(runtimes2.end() - lastfew,
+                                       runtimes2.end(),
+                                       (uint64_t)0)
+            / lastfew;
+    return std::make_tuple((double)unrolled / arr.size(),
+                           (double)one_reg / arr.size());
+}
+
+/*
+ * Same as bench_partition for the key-value partitions of 64-bit keys, with
+ * uint64_t values
+ */
+template <typename K>
+std::tuple<double, double> bench_partition_kv(const std::vector<K> keys,
+                                              const uint64_t iters,
+                                              const uint64_t lastfew)
+{
+    using vtype = zmm_vector<K>;
+    using index_type = zmm_vector<uint64_t>;
+    std::vector<K> keys_bckup = keys;
+    std::vector<uint64_t> values(keys.size());
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    const K pivot = keys[keys.size() / 2];
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        K smallest = vtype::type_max();
+        K biggest = vtype::type_min();
+        start = cycles_start();
+        partition_avx512_unrolled<vtype, X86_SIMD_SORT_UNROLL_KV, index_type>(
+                keys_bckup.data(),
+                values.data(),
+                0,
+                keys_bckup.size(),
+                pivot,
+                &smallest,
+                &biggest);
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        keys_bckup = keys;
+    }
+    uint64_t unrolled = std::accumulate(runtimes1.end() - lastfew,
+                                        runtimes1.end(),
+                                        (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        K smallest = vtype::type_max();
+        K biggest = vtype::type_min();
+        start = cycles_start();
+        partition_avx512<vtype, index_type>(keys_bckup.data(),
+                                            values.data(),
+                                            0,
+                                            keys_bckup.size(),
+                                            pivot,
+                                            &smallest,
+                                            &biggest);
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        keys_bckup = keys;
+    }
+    uint64_t one_reg = std::accumulate(runtimes2.end() - lastfew,
+                                       runtimes2.end(),
+                                       (uint64_t)0)
+            / lastfew;
+    return std::make_tuple((double)unrolled / keys.size(),
+                           (double)one_reg / keys.size());
+}
+
+/*
+ * Compares avx512_sort_copy from arr into a second array against copying arr
+ * and calling avx512_qsort on the copy
+ */
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_sort_copy(const std::vector<T> arr,
+                                               const uint64_t iters,
+                                               const uint64_t lastfew)
+{
+    std::vector<T> dst(arr.size());
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx512_sort_copy<T>(arr.data(), dst.data(), arr.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+    }
+    uint64_t sort_copy = std::accumulate(runtimes1.end() - lastfew,
+                                         runtimes1.end(),
+                                         (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::copy(arr.begin(), arr.end(), dst.begin());
+        avx512_qsort<T>(dst.data(), dst.size());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+    }
+    uint64_t copy_sort = std::accumulate(runtimes2.end() - lastfew,
+                                         runtimes2.end(),
+                                         (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(sort_copy, copy_sort);
+}
+
+/*
+ * Compares avx2_qsort against std::sort
+ */
+template <typename T>
+std::tuple<uint64_t, uint64_t> bench_avx2_sort(const std::vector<T> arr,
+                                               const uint64_t iters,
+                                               const uint64_t lastfew)
+{
+    std::vector<T> arr_bckup = arr;
+    std::vector<uint64_t> runtimes1, runtimes2;
+    uint64_t start(0), end(0);
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        avx2_qsort<T>(arr_bckup.data(), arr_bckup.size());
+        end = cycles_end();
+        runtimes1.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t avx2_sort = std::accumulate(runtimes1.end() - lastfew,
+                                         runtimes1.end(),
+                                         (uint64_t)0)
+            / lastfew;
+
+    for (uint64_t ii = 0; ii < iters; ++ii) {
+        start = cycles_start();
+        std::sort(arr_bckup.begin(), arr_bckup.end());
+        end = cycles_end();
+        runtimes2.emplace_back(end - start);
+        arr_bckup = arr;
+    }
+    uint64_t std_sort = std::accumulate(runtimes2.end() - lastfew,
+                                        runtimes2.end(),
+                                        (uint64_t)0)
+            / lastfew;
+    return std::make_tuple(avx2_sort, std_sort);
+}
+
+/*
+ * Rounds per second that nthreads threads get through when each of them sorts
+ * a copy of arr and then runs a scalar loop, over and over: the throughput of
+ * a whole process in which sorts run alongside scalar work. The loop is a
+ * chain of dependent multiplies, long enough to dominate the round, whose
+ * speed only depends on the frequency of the core.
+ */
+template <typename T>
+double bench_colocated_rounds(const std::vector<T> &arr,
+                              void (*sort)(T *, int64_t),
+                              const int nthreads,
+                              const double seconds)
+{
+    const auto deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration<double>(seconds);
+    uint64_t rounds = 0;
+#pragma omp parallel num_threads(nthreads) reduction(+ : rounds)
+    {
+        std::vector<T> arr_bckup;
+        uint64_t x = 1;
+        while (std::chrono::steady_clock::now() < deadline) {
+            arr_bckup = arr;
+            sort(arr_bckup.data(), arr_bckup.size());
+            for (int ii = 0; ii < (1 << 20); ++ii) {
+                x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            }
+            rounds++;
+        }
+        /* keeps the loop */
+        if (x == 0) { std::cout << x << std::endl; }
+    }
+    return rounds / seconds;
+}
+
+/*
+ * Compares avx512_ymm_qsort against avx512_qsort, each sharing the threads
+ * with scalar work
+ */
+template <typename T>
+std::tuple<double, double> bench_colocated_sort(const std::vector<T> arr,
+                                                const int nthreads,
+                                                const double seconds)
+{
+    double ymm_rounds = bench_colocated_rounds<T>(
+            arr, avx512_ymm_qsort<T>, nthreads, seconds);
+    double zmm_rounds = bench_colocated_rounds<T>(
+            arr, avx512_qsort<T>, nthreads, seconds);
+    return std::make_tuple(ymm_rounds, zmm_rounds);
+}
@@ -64,6 +64,33 @@ void run_bench(const std::string datatype)
         else if (datatype.find("limited") != std::string::npos) {
             arr = get_uniform_rand_array<T>(size, (T)10, (T)0);
         }
+        else if (datatype.find("runs") != std::string::npos) {
+            /* Four sorted runs, like appended logs */
+            arr = get_uniform_rand_array<T>(size);
+            for (int run = 0; run < 4; ++run) {
+                std::sort(arr.begin() + (int64_t)size * run / 4,
+                          arr.begin() + (int64_t)size * (run + 1) / 4);
+            }
+        }
+        else if (datatype.find("sawtooth") != std::string::npos) {
+            /* Period of 1/16th of the array */
+            for (int ii = 0; ii < size; ++ii) {
+                arr.emplace_back((T)(ii % (size / 16)));
+            }
+        }
+        else if (datatype.find("zipf") != std::string::npos) {
+            /* 1000 distinct values, the k-th one with weight 1 / k */
+            std::vector<double> weights(1000);
+            for (int kk = 0; kk < 1000; ++kk) {
+                weights[kk] = 1.0 / (kk + 1);
+            }
+            std::mt19937 gen(std::random_device {}());
+            std::discrete_distribution<int> dist(weights.begin(),
+                                                 weights.end());
+            for (int ii = 0; ii < size; ++ii) {
+                arr.emplace_back((T)dist(gen));
+            }
+        }
         else {
             std::cout << "Skipping unrecognized array type: " << datatype
                       << std::endl;
@@ -82,6 +109,327 @@ void run_bench(const std::string datatype)
     std::cout << std::setprecision(ss);
 }
 
+template <typename T>
+void run_bench_desc(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        auto out = bench_sort_desc(arr, 20, 10);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_parallel(const std::string name, const int nthreads)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    const std::string datatype = name + " t=" + std::to_string(nthreads);
+    void (*sort)(T *, int64_t, int) = (name == "sample")
+            ? avx512_sample_sort<T>
+            : avx512_qsort_parallel<T>;
+    std::vector<int> array_sizes = {1000000, 10000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        auto out = bench_sort_parallel(arr, sort, nthreads, 10, 5);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+/*
+ * Sizes around the crossover between avx512_radix_sort (or avx512_msd_qsort)
+ * and avx512_qsort
+ */
+template <typename T>
+void run_bench_radix(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {1000000, 10000000, 100000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        void (*sort)(T *, int64_t) = avx512_radix_sort<T>;
+        if (datatype == "msd") {
+            sort = [](T *arr, int64_t size) { avx512_msd_qsort<T>(arr, size); };
+        }
+        auto out = bench_radix_sort(arr, sort, 3, 2);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename K, typename V>
+void run_bench_radix_kv(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {1000000, 10000000};
+    for (auto size : array_sizes) {
+        std::vector<K> keys = get_uniform_rand_array<K>(size);
+        std::vector<V> values = get_uniform_rand_array<V>(size);
+        auto out = bench_radix_sort_kv(keys, values, 3, 2);
+        printLine(' ',
+                  datatype,
+                  typeid(K).name(),
+                  sizeof(K),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+/*
+ * Cycles per element of a single partition, unrolled and one register at a
+ * time
+ */
+template <typename T>
+void run_bench_partition(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(2);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        std::tuple<double, double> out;
+        if (datatype == "partition_kv") {
+            out = bench_partition_kv(arr, 100, 50);
+        }
+        else {
+            out = bench_partition(arr, 100, 50);
+        }
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_sort_copy(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000, 10000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        auto out = bench_sort_copy(arr, 10, 5);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_avx2(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr;
+        if (datatype.find("uniform") != std::string::npos) {
+            arr = get_uniform_rand_array<T>(size);
+        }
+        else if (datatype.find("limited") != std::string::npos) {
+            arr = get_uniform_rand_array<T>(size, (T)10, (T)0);
+        }
+        else {
+            std::cout << "Skipping unrecognized array type: " << datatype
+                      << std::endl;
+            return;
+        }
+        auto out = bench_avx2_sort(arr, 20, 10);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_colocated(const int nthreads)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    const std::string datatype = "colocated t=" + std::to_string(nthreads);
+    std::vector<int> array_sizes = {10000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        auto out = bench_colocated_sort(arr, nthreads, 2.0);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<0>(out) / std::get<1>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+/*
+ * 1M elements split into segments of random length, avglen on average
+ */
+template <typename T>
+void run_bench_segmented(const int64_t avglen)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    const std::string datatype = "segmented avg=" + std::to_string(avglen);
+    const int64_t size = 1000000;
+    std::vector<int64_t> offsets = {0};
+    std::vector<int64_t> lengths
+            = get_uniform_rand_array<int64_t>(size, 2 * avglen, 0);
+    for (auto len : lengths) {
+        if (offsets.back() + len > size) { break; }
+        offsets.push_back(offsets.back() + len);
+    }
+    std::vector<T> arr = get_uniform_rand_array<T>(offsets.back());
+    auto out = bench_segmented_sort(arr, offsets, 20, 10);
+    printLine(' ',
+              datatype,
+              typeid(T).name(),
+              sizeof(T),
+              offsets.back(),
+              std::get<0>(out),
+              std::get<1>(out),
+              (float)std::get<1>(out) / std::get<0>(out));
+    std::cout << std::setprecision(ss);
+}
+
+/*
+ * 10000 arrays of arrsize elements each
+ */
+template <typename T>
+void run_bench_batched(const int32_t arrsize)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    const std::string datatype = "batched n=" + std::to_string(arrsize);
+    const int64_t batchsize = 10000;
+    std::vector<T> arr = get_uniform_rand_array<T>(arrsize * batchsize);
+    auto out = bench_batched_sort(arr, arrsize, 20, 10);
+    printLine(' ',
+              datatype,
+              typeid(T).name(),
+              sizeof(T),
+              arrsize * batchsize,
+              std::get<0>(out),
+              std::get<1>(out),
+              (float)std::get<1>(out) / std::get<0>(out));
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_partial(const std::string datatype, const int64_t k)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        auto out = bench_partial_sort(arr, k, 20, 10);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
+template <typename T>
+void run_bench_argsort(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<T> arr;
+        if (datatype.find("arg_uniform") != std::string::npos) {
+            arr = get_uniform_rand_array<T>(size);
+        }
+        else if (datatype.find("arg_limited") != std::string::npos) {
+            arr = get_uniform_rand_array<T>(size, (T)10, (T)0);
+        }
+        else {
+            std::cout << "Skipping unrecognized array type: " << datatype
+                      << std::endl;
+            return;
+        }
+        auto out = bench_argsort(arr, 20, 10);
+        printLine(' ',
+                  datatype,
+                  typeid(T).name(),
+                  sizeof(T),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+
 template <typename K, typename V = uint64_t>
 void run_bench_kv(const std::string datatype)
 {
@@ -127,7 +475,50 @@ void run_bench_kv(const std::string datatype)
         auto out = bench_sort_kv(keys, values, sortedarr, 20, 10);
         printLine(' ',
                   datatype,
-                  typeid(K).name(),
+                  std::string(typeid(K).name()) + "," + typeid(V).name(),
+                  sizeof(K),
+                  size,
+                  std::get<0>(out),
+                  std::get<1>(out),
+                  (float)std::get<1>(out) / std::get<0>(out));
+    }
+    std::cout << std::setprecision(ss);
+}
+template <typename K, typename V = uint64_t>
+void run_bench_stable_kv(const std::string datatype)
+{
+    std::streamsize ss = std::cout.precision();
+    std::cout << std::fixed;
+    std::cout << std::setprecision(1);
+    std::vector<int> array_sizes = {10000, 100000, 1000000};
+    for (auto size : array_sizes) {
+        std::vector<K> keys;
+        std::vector<V> values;
+        std::vector<sorted_t<K, V>> sortedarr;
+
+        if (datatype.find("stable_uniform") != std::string::npos) {
+            keys = get_uniform_rand_array<K>(size);
+        }
+        else if (datatype.find("stable_limited") != std::string::npos) {
+            keys = get_uniform_rand_array<K>(size, (K)10, (K)0);
+        }
+        else {
+            std::cout << "Skipping unrecognized array type: " << datatype
+                      << std::endl;
+            return;
+        }
+        values = get_uniform_rand_array<V>(size);
+        for (size_t i = 0; i < keys.size(); i++) {
+            sorted_t<K, V> tmp_s;
+            tmp_s.key = keys[i];
+            tmp_s.value = values[i];
+            sortedarr.emplace_back(tmp_s);
+        }
+
+        auto out = bench_stable_sort_kv(keys, values, sortedarr, 20, 10);
+        printLine(' ',
+                  datatype,
+                  std::string(typeid(K).name()) + "," + typeid(V).name(),
                   sizeof(K),
                   size,
                   std::get<0>(out),
@@ -151,13 +542,178 @@ void bench_all(const std::string datatype)
         }
     }
 }
+void bench_all_desc(const std::string datatype)
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_desc<uint32_t>(datatype);
+        run_bench_desc<int32_t>(datatype);
+        run_bench_desc<float>(datatype);
+        run_bench_desc<uint64_t>(datatype);
+        run_bench_desc<int64_t>(datatype);
+        run_bench_desc<double>(datatype);
+        if (cpu_has_avx512_vbmi2()) {
+            run_bench_desc<uint16_t>(datatype);
+            run_bench_desc<int16_t>(datatype);
+        }
+    }
+}
+/*
+ * Scaling of avx512_qsort_parallel ("parallel") or avx512_sample_sort
+ * ("sample") from 1 thread to all the threads OpenMP would use by default
+ */
+void bench_all_parallel(const std::string name)
+{
+    int max_threads = 1;
+#ifdef X86_SIMD_SORT_USE_OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    std::vector<int> thread_counts;
+    for (int nthreads = 1; nthreads < max_threads; nthreads *= 2) {
+        thread_counts.push_back(nthreads);
+    }
+    thread_counts.push_back(max_threads);
+    if (cpu_has_avx512bw()) {
+        for (auto nthreads : thread_counts) {
+            run_bench_parallel<uint32_t>(name, nthreads);
+            run_bench_parallel<float>(name, nthreads);
+            run_bench_parallel<uint64_t>(name, nthreads);
+            run_bench_parallel<double>(name, nthreads);
+        }
+    }
+}
+void bench_all_radix()
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_radix<uint32_t>("radix");
+        run_bench_radix<float>("radix");
+        run_bench_radix<uint64_t>("radix");
+        run_bench_radix<double>("radix");
+        run_bench_radix_kv<uint32_t, uint32_t>("radix_kv");
+        run_bench_radix_kv<uint64_t, uint64_t>("radix_kv");
+        run_bench_radix<uint32_t>("msd");
+        run_bench_radix<float>("msd");
+        run_bench_radix<uint64_t>("msd");
+        run_bench_radix<double>("msd");
+    }
+}
+void bench_all_partition()
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_partition<uint32_t>("partition");
+        run_bench_partition<float>("partition");
+        run_bench_partition<uint64_t>("partition");
+        run_bench_partition<double>("partition");
+        run_bench_partition<uint64_t>("partition_kv");
+        run_bench_partition<double>("partition_kv");
+    }
+}
+void bench_all_sort_copy()
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_sort_copy<uint32_t>("sort_copy");
+        run_bench_sort_copy<float>("sort_copy");
+        run_bench_sort_copy<uint64_t>("sort_copy");
+        run_bench_sort_copy<double>("sort_copy");
+        if (cpu_has_avx512_vbmi2()) {
+            run_bench_sort_copy<uint16_t>("sort_copy");
+        }
+    }
+}
+void bench_all_avx2(const std::string datatype)
+{
+    if (cpu_has_avx2()) {
+        run_bench_avx2<uint32_t>(datatype);
+        run_bench_avx2<int32_t>(datatype);
+        run_bench_avx2<float>(datatype);
+        run_bench_avx2<uint64_t>(datatype);
+        run_bench_avx2<int64_t>(datatype);
+        run_bench_avx2<double>(datatype);
+    }
+}
+/*
+ * avx512_ymm_qsort and avx512_qsort on every thread OpenMP would use by
+ * default, each thread also running scalar work
+ */
+void bench_all_colocated()
+{
+    int nthreads = 1;
+#ifdef X86_SIMD_SORT_USE_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    if (cpu_has_avx512bw()) {
+        run_bench_colocated<uint32_t>(nthreads);
+        run_bench_colocated<float>(nthreads);
+        run_bench_colocated<uint64_t>(nthreads);
+        run_bench_colocated<double>(nthreads);
+    }
+}
+void bench_all_segmented(const int64_t avglen)
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_segmented<uint32_t>(avglen);
+        run_bench_segmented<float>(avglen);
+        run_bench_segmented<uint64_t>(avglen);
+        run_bench_segmented<double>(avglen);
+        if (cpu_has_avx512_vbmi2()) { run_bench_segmented<uint16_t>(avglen); }
+    }
+}
+void bench_all_batched(const int32_t arrsize)
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_batched<uint32_t>(arrsize);
+        run_bench_batched<float>(arrsize);
+        run_bench_batched<uint64_t>(arrsize);
+        run_bench_batched<double>(arrsize);
+        if (cpu_has_avx512_vbmi2()) { run_bench_batched<uint16_t>(arrsize); }
+    }
+}
+void bench_all_partial(const int64_t k)
+{
+    const std::string datatype = "partial k=" + std::to_string(k);
+    if (cpu_has_avx512bw()) {
+        run_bench_partial<uint32_t>(datatype, k);
+        run_bench_partial<int32_t>(datatype, k);
+        run_bench_partial<float>(datatype, k);
+        run_bench_partial<uint64_t>(datatype, k);
+        run_bench_partial<int64_t>(datatype, k);
+        run_bench_partial<double>(datatype, k);
+        if (cpu_has_avx512_vbmi2()) {
+            run_bench_partial<uint16_t>(datatype, k);
+            run_bench_partial<int16_t>(datatype, k);
+        }
+    }
+}
+void bench_all_argsort(const std::string datatype)
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_argsort<uint32_t>(datatype);
+        run_bench_argsort<int32_t>(datatype);
+        run_bench_argsort<float>(datatype);
+        run_bench_argsort<uint64_t>(datatype);
+        run_bench_argsort<int64_t>(datatype);
+        run_bench_argsort<double>(datatype);
+    }
+}
 void bench_all_kv(const std::string datatype)
 {
     if (cpu_has_avx512bw()) {
-
+        run_bench_kv<uint32_t, uint32_t>(datatype);
+        run_bench_kv<int32_t, uint32_t>(datatype);
+        run_bench_kv<float, uint32_t>(datatype);
         run_bench_kv<uint64_t>(datatype);
         run_bench_kv<int64_t>(datatype);
         run_bench_kv<double>(datatype);
+        run_bench_kv<uint64_t, uint32_t>(datatype);
+        run_bench_kv<int64_t, uint32_t>(datatype);
+        run_bench_kv<double, uint32_t>(datatype);
+    }
+}
+void bench_all_stable_kv(const std::string datatype)
+{
+    if (cpu_has_avx512bw()) {
+        run_bench_stable_kv<uint64_t>(datatype);
+        run_bench_stable_kv<int64_t>(datatype);
+        run_bench_stable_kv<double>(datatype);
     }
 }
 int main(/*int argc, char *argv[]*/)
@@ -174,12 +730,98 @@ int main(/*int argc, char *argv[]*/)
     bench_all("uniform random");
     bench_all("reverse");
     bench_all("ordered");
+    bench_all("sorted runs");
     bench_all("limitedrange");
+    bench_all("zipf");
+    bench_all("sawtooth");
+
+    bench_all_desc("desc_uniform");
+
+    bench_all_parallel("parallel");
+    bench_all_parallel("sample");
+
+    bench_all_partial(100);
+
+    bench_all_segmented(8);
+    bench_all_segmented(64);
+    bench_all_segmented(1024);
+
+    bench_all_batched(8);
+    bench_all_batched(16);
+    bench_all_batched(32);
+
+    bench_all_argsort("arg_uniform random");
+    bench_all_argsort("arg_limitedrange");
 
     bench_all_kv("kv_uniform random");
     bench_all_kv("kv_reverse");
     bench_all_kv("kv_ordered");
     bench_all_kv("kv_limitedrange");
+
+    bench_all_stable_kv("stable_uniform");
+    bench_all_stable_kv("stable_limited");
+
+    /* radix sort is compared against avx512_qsort, not std::sort */
+    printLine('-', "", "", "", "", "", "", "");
+    printLine(' ',
+              "array type",
+              "typeid name",
+              "dtype size",
+              "array size",
+              "radix/msd sort",
+              "avx512 sort",
+              "speed up");
+    printLine('-', "", "", "", "", "", "", "");
+    bench_all_radix();
+    printLine('-', "", "", "", "", "", "", "");
+    /* cycles per element of the partition alone */
+    printLine(' ',
+              "array type",
+              "typeid name",
+              "dtype size",
+              "array size",
+              "unrolled c/elem",
+              "1 reg c/elem",
+              "speed up");
+    printLine('-', "", "", "", "", "", "", "");
+    bench_all_partition();
+    printLine('-', "", "", "", "", "", "", "");
+    /* avx512_sort_copy against a copy followed by avx512_qsort */
+    printLine(' ',
+              "array type",
+              "typeid name",
+              "dtype size",
+              "array size",
+              "sort_copy",
+              "copy + sort",
+              "speed up");
+    printLine('-', "", "", "", "", "", "", "");
+    bench_all_sort_copy();
+    printLine('-', "", "", "", "", "", "", "");
+    /* the AVX2 backend against std::sort */
+    printLine(' ',
+              "array type",
+              "typeid name",
+              "dtype size",
+              "array size",
+              "avx2 sort",
+              "std sort",
+              "speed up");
+    printLine('-', "", "", "", "", "", "", "");
+    bench_all_avx2("avx2_uniform random");
+    bench_all_avx2("avx2_limitedrange");
+    printLine('-', "", "", "", "", "", "", "");
+    /* rounds of sort + scalar loop per second, higher is better */
+    printLine(' ',
+              "array type",
+              "typeid name",
+              "dtype size",
+              "array size",
+              "ymm rounds/s",
+              "zmm rounds/s",
+              "ymm speed up");
+    printLine('-', "", "", "", "", "", "", "");
+    bench_all_colocated();
     printLine('-', "", "", "", "", "", "", "");
     return 0;
 }
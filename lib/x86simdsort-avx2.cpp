@@ -0,0 +1,54 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+/*
+ * Compiled with -mavx2 -mbmi2 -mpopcnt -mfma.
+ *
+ * The sort headers are included inside a namespace of their own, so that
+ * nothing they define is shared with the other instruction sets, or with a
+ * program that includes them too. The headers they include are opened first,
+ * outside of it.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "x86simdsort-internal.h"
+
+namespace xss {
+namespace avx2 {
+#include "avx2-32bit-qsort.hpp"
+#include "avx2-64bit-qsort.hpp"
+
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize)
+    {
+        avx2_qsort<T>(arr, arrsize);
+    }
+
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize)
+    {
+        avx2_qselect<T>(arr, k, arrsize);
+    }
+
+#define X86_SIMD_SORT_AVX2(T) \
+    template void qsort<T>(T *, int64_t); \
+    template void select<T>(T *, int64_t, int64_t);
+
+    X86_SIMD_SORT_AVX2(int32_t)
+    X86_SIMD_SORT_AVX2(uint32_t)
+    X86_SIMD_SORT_AVX2(float)
+    X86_SIMD_SORT_AVX2(int64_t)
+    X86_SIMD_SORT_AVX2(uint64_t)
+    X86_SIMD_SORT_AVX2(double)
+} // namespace avx2
+} // namespace xss
@@ -0,0 +1,60 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+/*
+ * Compiled with the flags of the AVX-512 version, -mavx512vbmi2 and -mf16c.
+ *
+ * The sort headers are included inside a namespace of their own, so that
+ * nothing they define is shared with the other instruction sets, or with a
+ * program that includes them too. The headers they include are opened first,
+ * outside of it.
+ *
+ * immintrin.h comes first, with the uninitialized warnings off: with -Wall,
+ * GCC 12 warns about the _mm512_undefined_* values that its AVX-512
+ * intrinsics start from, at every call of them.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#ifndef __clang__
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "x86simdsort-internal.h"
+
+namespace xss {
+namespace avx512_icl {
+#include "avx512-16bit-qsort.hpp"
+
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize)
+    {
+        avx512_qsort<T>(arr, arrsize);
+    }
+
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize)
+    {
+        avx512_qselect<T>(arr, k, arrsize);
+    }
+
+#define X86_SIMD_SORT_AVX512_ICL(T) \
+    template void qsort<T>(T *, int64_t); \
+    template void select<T>(T *, int64_t, int64_t);
+
+    X86_SIMD_SORT_AVX512_ICL(int16_t)
+    X86_SIMD_SORT_AVX512_ICL(uint16_t)
+} // namespace avx512_icl
+} // namespace xss
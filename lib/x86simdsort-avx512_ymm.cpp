@@ -0,0 +1,55 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+/*
+ * Compiled with -mavx512f -mavx512vl -mprefer-vector-width=256 -mmove-max=256
+ * -mstore-max=256 -mavx2 -mbmi2 -mpopcnt -mfma: nothing in it may use a ZMM
+ * register.
+ *
+ * The sort headers are included inside a namespace of their own, so that
+ * nothing they define is shared with the other instruction sets, or with a
+ * program that includes them too. The headers they include are opened first,
+ * outside of it.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "x86simdsort-internal.h"
+
+namespace xss {
+namespace avx512_ymm {
+#include "avx512-ymm-qsort.hpp"
+
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize)
+    {
+        avx512_ymm_qsort<T>(arr, arrsize);
+    }
+
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize)
+    {
+        avx512_ymm_qselect<T>(arr, k, arrsize);
+    }
+
+#define X86_SIMD_SORT_AVX512_YMM(T) \
+    template void qsort<T>(T *, int64_t); \
+    template void select<T>(T *, int64_t, int64_t);
+
+    X86_SIMD_SORT_AVX512_YMM(int32_t)
+    X86_SIMD_SORT_AVX512_YMM(uint32_t)
+    X86_SIMD_SORT_AVX512_YMM(float)
+    X86_SIMD_SORT_AVX512_YMM(int64_t)
+    X86_SIMD_SORT_AVX512_YMM(uint64_t)
+    X86_SIMD_SORT_AVX512_YMM(double)
+} // namespace avx512_ymm
+} // namespace xss
@@ -0,0 +1,64 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+#ifndef X86_SIMD_SORT_INTERNAL
+#define X86_SIMD_SORT_INTERNAL
+
+/*
+ * The versions of the routines of x86simdsort.h, one namespace per
+ * instruction set. Each namespace is defined by its own translation unit,
+ * compiled with the flags of that instruction set, and only for the dtypes
+ * it has code for:
+ *
+ * scalar:      every dtype, std::sort and std::nth_element
+ * avx2:        qsort and select of the 32-bit and 64-bit dtypes
+ * avx512_ymm:  qsort and select of the 32-bit and 64-bit dtypes, AVX-512VL on
+ *              256-bit registers only
+ * avx512_skx:  qsort, select and argsort of the 32-bit and 64-bit dtypes
+ * avx512_icl:  qsort and select of the 16-bit dtypes
+ *
+ * Nothing else is shared between them: a template instantiated by two of
+ * them would be merged by the linker into whichever copy it sees first.
+ */
+
+#include <cstdint>
+
+namespace xss {
+namespace scalar {
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize);
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize);
+    template <typename T>
+    void argsort(const T *arr, int64_t *arg, int64_t arrsize);
+} // namespace scalar
+namespace avx2 {
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize);
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize);
+} // namespace avx2
+namespace avx512_ymm {
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize);
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize);
+} // namespace avx512_ymm
+namespace avx512_skx {
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize);
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize);
+    template <typename T>
+    void argsort(const T *arr, int64_t *arg, int64_t arrsize);
+} // namespace avx512_skx
+namespace avx512_icl {
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize);
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize);
+} // namespace avx512_icl
+} // namespace xss
+#endif // X86_SIMD_SORT_INTERNAL
@@ -0,0 +1,68 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+#include "x86simdsort-internal.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace xss {
+namespace scalar {
+    /*
+     * The order of avx512_qsort: NAN's after everything else. The lambda
+     * also gives std::sort a comparator type of its own, which no other
+     * translation unit instantiates it with.
+     */
+    template <typename T>
+    static auto compare()
+    {
+        return [](const T &a, const T &b) {
+            if constexpr (std::is_floating_point<T>::value) {
+                if (std::isnan(a)) { return false; }
+                if (std::isnan(b)) { return true; }
+            }
+            return a < b;
+        };
+    }
+
+    template <typename T>
+    void qsort(T *arr, int64_t arrsize)
+    {
+        std::sort(arr, arr + arrsize, compare<T>());
+    }
+
+    template <typename T>
+    void select(T *arr, int64_t k, int64_t arrsize)
+    {
+        if (k < arrsize) {
+            std::nth_element(arr, arr + k, arr + arrsize, compare<T>());
+        }
+    }
+
+    template <typename T>
+    void argsort(const T *arr, int64_t *arg, int64_t arrsize)
+    {
+        auto cmp = compare<T>();
+        std::iota(arg, arg + arrsize, 0);
+        std::sort(arg, arg + arrsize, [arr, cmp](int64_t a, int64_t b) {
+            return cmp(arr[a], arr[b]);
+        });
+    }
+
+#define X86_SIMD_SORT_SCALAR(T) \
+    template void qsort<T>(T *, int64_t); \
+    template void select<T>(T *, int64_t, int64_t); \
+    template void argsort<T>(const T *, int64_t *, int64_t);
+
+    X86_SIMD_SORT_SCALAR(int16_t)
+    X86_SIMD_SORT_SCALAR(uint16_t)
+    X86_SIMD_SORT_SCALAR(int32_t)
+    X86_SIMD_SORT_SCALAR(uint32_t)
+    X86_SIMD_SORT_SCALAR(float)
+    X86_SIMD_SORT_SCALAR(int64_t)
+    X86_SIMD_SORT_SCALAR(uint64_t)
+    X86_SIMD_SORT_SCALAR(double)
+} // namespace scalar
+} // namespace xss
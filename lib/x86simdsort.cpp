@@ -0,0 +1,231 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+/*
+ * Runtime dispatch of libx86simdsort. Every routine and dtype has a function
+ * pointer, which starts out pointing at a resolver: the first call replaces
+ * it with the version of the best instruction set the CPU and the OS support
+ * and forwards to it. All of them are resolved when the library is loaded, so
+ * that after that an exported routine is a single indirect call through its
+ * pointer. The resolvers are only there for calls made from static
+ * initializers that run before ours.
+ *
+ * The environment variable X86_SIMD_SORT_ISA, read once, caps the instruction
+ * set at one of the names isa() returns. avx512_ymm sorts on 256-bit registers
+ * with AVX-512VL, and is only picked on its own by a CPU that has AVX-512VL
+ * but not the rest of avx512_skx: X86_SIMD_SORT_ISA=avx512_ymm is there for
+ * the processors that lower their frequency while 512-bit instructions run.
+ * The 16-bit dtypes and argsort have no avx512_ymm version and use the scalar
+ * ones then.
+ *
+ * This file is compiled without any ISA flags.
+ */
+
+#include "x86simdsort.h"
+#include "cpuinfo.h"
+#include "x86simdsort-internal.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+enum class isa_t { scalar, avx2, avx512_ymm, avx512_skx, avx512_icl };
+
+const char *isa_name(isa_t isa)
+{
+    switch (isa) {
+        case isa_t::avx512_icl: return "avx512_icl";
+        case isa_t::avx512_skx: return "avx512_skx";
+        case isa_t::avx512_ymm: return "avx512_ymm";
+        case isa_t::avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+isa_t supported_isa()
+{
+    if (!cpu_has_avx2() || !cpu_has_bmi2() || !cpu_has_fma()
+        || !cpu_has_popcnt() || !check_os_supports_avx()) {
+        return isa_t::scalar;
+    }
+    if (!cpu_has_avx512vl() || !check_os_supports_avx512()) {
+        return isa_t::avx2;
+    }
+    if (!cpu_has_avx512_skx()) { return isa_t::avx512_ymm; }
+    if (!cpu_has_avx512_vbmi2()) { return isa_t::avx512_skx; }
+    return isa_t::avx512_icl;
+}
+
+isa_t best_isa()
+{
+    static const isa_t isa = []() {
+        const isa_t supported = supported_isa();
+        const char *requested = std::getenv("X86_SIMD_SORT_ISA");
+        if (requested == nullptr) { return supported; }
+        for (isa_t cap : {isa_t::scalar,
+                          isa_t::avx2,
+                          isa_t::avx512_ymm,
+                          isa_t::avx512_skx,
+                          isa_t::avx512_icl}) {
+            if (std::strcmp(requested, isa_name(cap)) == 0) {
+                return std::min(cap, supported);
+            }
+        }
+        return supported;
+    }();
+    return isa;
+}
+
+template <typename T>
+using qsort_t = void (*)(T *, int64_t);
+template <typename T>
+using select_t = void (*)(T *, int64_t, int64_t);
+template <typename T>
+using argsort_t = void (*)(const T *, int64_t *, int64_t);
+
+/* The 16-bit dtypes only have an AVX-512 VBMI2 version */
+template <typename T>
+qsort_t<T> pick_qsort()
+{
+    const isa_t isa = best_isa();
+    if constexpr (sizeof(T) == 2) {
+        if (isa == isa_t::avx512_icl) { return xss::avx512_icl::qsort<T>; }
+    }
+    else {
+        if (isa >= isa_t::avx512_skx) { return xss::avx512_skx::qsort<T>; }
+        if (isa == isa_t::avx512_ymm) { return xss::avx512_ymm::qsort<T>; }
+        if (isa >= isa_t::avx2) { return xss::avx2::qsort<T>; }
+    }
+    return xss::scalar::qsort<T>;
+}
+
+template <typename T>
+select_t<T> pick_select()
+{
+    const isa_t isa = best_isa();
+    if constexpr (sizeof(T) == 2) {
+        if (isa == isa_t::avx512_icl) { return xss::avx512_icl::select<T>; }
+    }
+    else {
+        if (isa >= isa_t::avx512_skx) { return xss::avx512_skx::select<T>; }
+        if (isa == isa_t::avx512_ymm) { return xss::avx512_ymm::select<T>; }
+        if (isa >= isa_t::avx2) { return xss::avx2::select<T>; }
+    }
+    return xss::scalar::select<T>;
+}
+
+template <typename T>
+argsort_t<T> pick_argsort()
+{
+    if (best_isa() >= isa_t::avx512_skx) {
+        return xss::avx512_skx::argsort<T>;
+    }
+    return xss::scalar::argsort<T>;
+}
+
+template <typename T>
+void resolve_qsort(T *arr, int64_t arrsize);
+template <typename T>
+void resolve_select(T *arr, int64_t k, int64_t arrsize);
+template <typename T>
+void resolve_argsort(const T *arr, int64_t *arg, int64_t arrsize);
+
+template <typename T>
+qsort_t<T> qsort_ptr = resolve_qsort<T>;
+template <typename T>
+select_t<T> select_ptr = resolve_select<T>;
+template <typename T>
+argsort_t<T> argsort_ptr = resolve_argsort<T>;
+
+template <typename T>
+void resolve_qsort(T *arr, int64_t arrsize)
+{
+    qsort_ptr<T> = pick_qsort<T>();
+    qsort_ptr<T>(arr, arrsize);
+}
+
+template <typename T>
+void resolve_select(T *arr, int64_t k, int64_t arrsize)
+{
+    select_ptr<T> = pick_select<T>();
+    select_ptr<T>(arr, k, arrsize);
+}
+
+template <typename T>
+void resolve_argsort(const T *arr, int64_t *arg, int64_t arrsize)
+{
+    argsort_ptr<T> = pick_argsort<T>();
+    argsort_ptr<T>(arr, arg, arrsize);
+}
+
+template <typename T>
+void resolve_sort()
+{
+    qsort_ptr<T> = pick_qsort<T>();
+    select_ptr<T> = pick_select<T>();
+}
+
+template <typename T>
+void resolve_all()
+{
+    resolve_sort<T>();
+    argsort_ptr<T> = pick_argsort<T>();
+}
+
+__attribute__((constructor)) void resolve_at_load()
+{
+    resolve_sort<int16_t>();
+    resolve_sort<uint16_t>();
+    resolve_all<int32_t>();
+    resolve_all<uint32_t>();
+    resolve_all<float>();
+    resolve_all<int64_t>();
+    resolve_all<uint64_t>();
+    resolve_all<double>();
+}
+} // namespace
+
+namespace x86simdsort {
+
+#define X86_SIMD_SORT_DISPATCH_SORT(T) \
+    template <> \
+    void qsort<T>(T * arr, int64_t arrsize) \
+    { \
+        qsort_ptr<T>(arr, arrsize); \
+    } \
+    template <> \
+    void select<T>(T * arr, int64_t k, int64_t arrsize) \
+    { \
+        select_ptr<T>(arr, k, arrsize); \
+    }
+
+#define X86_SIMD_SORT_DISPATCH_ARGSORT(T) \
+    template <> \
+    void argsort<T>(const T *arr, int64_t *arg, int64_t arrsize) \
+    { \
+        argsort_ptr<T>(arr, arg, arrsize); \
+    }
+
+X86_SIMD_SORT_DISPATCH_SORT(int16_t)
+X86_SIMD_SORT_DISPATCH_SORT(uint16_t)
+X86_SIMD_SORT_DISPATCH_SORT(int32_t)
+X86_SIMD_SORT_DISPATCH_SORT(uint32_t)
+X86_SIMD_SORT_DISPATCH_SORT(float)
+X86_SIMD_SORT_DISPATCH_SORT(int64_t)
+X86_SIMD_SORT_DISPATCH_SORT(uint64_t)
+X86_SIMD_SORT_DISPATCH_SORT(double)
+X86_SIMD_SORT_DISPATCH_ARGSORT(int32_t)
+X86_SIMD_SORT_DISPATCH_ARGSORT(uint32_t)
+X86_SIMD_SORT_DISPATCH_ARGSORT(float)
+X86_SIMD_SORT_DISPATCH_ARGSORT(int64_t)
+X86_SIMD_SORT_DISPATCH_ARGSORT(uint64_t)
+X86_SIMD_SORT_DISPATCH_ARGSORT(double)
+
+const char *isa()
+{
+    return isa_name(best_isa());
+}
+
+} // namespace x86simdsort
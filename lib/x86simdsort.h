@@ -0,0 +1,58 @@
+/*******************************************
+ * * Copyright (C) 2022 Intel Corporation
+ * * SPDX-License-Identifier: BSD-3-Clause
+ * *******************************************/
+
+#ifndef X86_SIMD_SORT_DISPATCH
+#define X86_SIMD_SORT_DISPATCH
+
+/*
+ * Entry points of libx86simdsort, the compiled version of the headers in
+ * src/. It holds one version of every routine per instruction set and picks
+ * the best one that the CPU and the OS support when it is loaded, so that a
+ * single binary runs everywhere. Calling these costs one indirect call on top
+ * of the routine.
+ *
+ * qsort and select:  int16_t, uint16_t, int32_t, uint32_t, float, int64_t,
+ *                    uint64_t and double
+ * argsort:           int32_t, uint32_t, float, int64_t, uint64_t and double
+ */
+
+#include <cstdint>
+
+#if defined(__GNUC__)
+#define X86_SIMD_SORT_EXPORT __attribute__((visibility("default")))
+#else
+#define X86_SIMD_SORT_EXPORT
+#endif
+
+namespace x86simdsort {
+
+/*
+ * Sorts arr in ascending order, as avx512_qsort<T>: NAN's go to the end
+ */
+template <typename T>
+X86_SIMD_SORT_EXPORT void qsort(T *arr, int64_t arrsize);
+
+/*
+ * Moves the k-th smallest element to arr[k], with the smaller ones before it
+ * and the larger ones after it, as avx512_qselect<T>
+ */
+template <typename T>
+X86_SIMD_SORT_EXPORT void select(T *arr, int64_t k, int64_t arrsize);
+
+/*
+ * Fills arg with the indices that sort arr, as avx512_argsort<T>
+ */
+template <typename T>
+X86_SIMD_SORT_EXPORT void argsort(const T *arr, int64_t *arg, int64_t arrsize);
+
+/*
+ * Name of the instruction set the routines were picked for: "scalar",
+ * "avx2", "avx512_ymm", "avx512_skx" or "avx512_icl". The environment
+ * variable X86_SIMD_SORT_ISA, set to one of these names, caps it.
+ */
+X86_SIMD_SORT_EXPORT const char *isa();
+
+} // namespace x86simdsort
+#endif // X86_SIMD_SORT_DISPATCH
@@ -0,0 +1,446 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+#ifndef AVX2_QSORT_32BIT
+#define AVX2_QSORT_32BIT
+
+#include "avx2-common-qsort.h"
+
+/*
+ * Constants used in sorting 8 elements in a YMM register: reversing it and
+ * swapping its 128-bit halves
+ */
+#define NETWORK_AVX2_32BIT_1 0, 1, 2, 3, 4, 5, 6, 7
+#define NETWORK_AVX2_32BIT_2 3, 2, 1, 0, 7, 6, 5, 4
+
+template <>
+struct avx2_vector<int32_t> {
+    using type_t = int32_t;
+    using zmm_t = __m256i;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_INT32;
+    }
+    static type_t type_min()
+    {
+        return X86_SIMD_SORT_MIN_INT32;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi32(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpgt_epi32(y, x);
+        return knot_opmask(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpeq_epi32(x, y);
+        return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((zmm_t const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_32bit[mask]);
+        _mm256_maskstore_epi32((int *)mem,
+                               avx2_first_lanes_32bit(_mm_popcnt_u32(mask)),
+                               _mm256_permutevar8x32_epi32(x, perm));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_32bit(mask);
+        zmm_t y = _mm256_maskload_epi32((int const *)mem, vmask);
+        return _mm256_blendv_epi8(x, y, vmask);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, avx2_mask_vec_32bit(mask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_epi32((int *)mem, avx2_mask_vec_32bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epi32(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epi32(x, y);
+    }
+    static zmm_t permutexvar(__m256i idx, zmm_t ymm)
+    {
+        return _mm256_permutevar8x32_epi32(ymm, idx);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_1), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = max(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return _mm256_cvtsi256_si32(v);
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = min(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return _mm256_cvtsi256_si32(v);
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        return _mm256_shuffle_epi32(ymm, mask);
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_epi32(x, y, mask);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_si256((zmm_t *)mem, x);
+    }
+};
+template <>
+struct avx2_vector<uint32_t> {
+    using type_t = uint32_t;
+    using zmm_t = __m256i;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_UINT32;
+    }
+    static type_t type_min()
+    {
+        return 0;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi32(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpeq_epi32(_mm256_max_epu32(x, y), x);
+        return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpeq_epi32(x, y);
+        return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((zmm_t const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_32bit[mask]);
+        _mm256_maskstore_epi32((int *)mem,
+                               avx2_first_lanes_32bit(_mm_popcnt_u32(mask)),
+                               _mm256_permutevar8x32_epi32(x, perm));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_32bit(mask);
+        zmm_t y = _mm256_maskload_epi32((int const *)mem, vmask);
+        return _mm256_blendv_epi8(x, y, vmask);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, avx2_mask_vec_32bit(mask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_epi32((int *)mem, avx2_mask_vec_32bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epu32(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epu32(x, y);
+    }
+    static zmm_t permutexvar(__m256i idx, zmm_t ymm)
+    {
+        return _mm256_permutevar8x32_epi32(ymm, idx);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_1), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = max(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return (type_t)_mm256_cvtsi256_si32(v);
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = min(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return (type_t)_mm256_cvtsi256_si32(v);
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        return _mm256_shuffle_epi32(ymm, mask);
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_epi32(x, y, mask);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_si256((zmm_t *)mem, x);
+    }
+};
+template <>
+struct avx2_vector<float> {
+    using type_t = float;
+    using zmm_t = __m256;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_INFINITYF;
+    }
+    static type_t type_min()
+    {
+        return -X86_SIMD_SORT_INFINITYF;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_ps(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_GE_OQ));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_movemask_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_ps((float const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_32bit[mask]);
+        _mm256_maskstore_ps((float *)mem,
+                            avx2_first_lanes_32bit(_mm_popcnt_u32(mask)),
+                            _mm256_permutevar8x32_ps(x, perm));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_32bit(mask);
+        zmm_t y = _mm256_maskload_ps((float const *)mem, vmask);
+        return _mm256_blendv_ps(x, y, _mm256_castsi256_ps(vmask));
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        __m256i vmask = avx2_mask_vec_32bit(mask);
+        return _mm256_blendv_ps(x, y, _mm256_castsi256_ps(vmask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_ps((float *)mem, avx2_mask_vec_32bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_ps(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_ps(x, y);
+    }
+    static zmm_t permutexvar(__m256i idx, zmm_t ymm)
+    {
+        return _mm256_permutevar8x32_ps(ymm, idx);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_1), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = max(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return _mm256_cvtss_f32(v);
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2), v));
+        v = min(v, shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(v));
+        return _mm256_cvtss_f32(v);
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_ps(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        return _mm256_permute_ps(ymm, mask);
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_ps(x, y, mask);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_ps((float *)mem, x);
+    }
+};
+
+/*
+ * Bitonic networks of the 8 lanes of a YMM register. Every step compares each
+ * lane with a partner lane, and the lanes set in the mask of cmp_merge_avx2
+ * (those with the larger index of the two) keep the maximum.
+ */
+template <typename vtype>
+struct avx2_network<vtype, 8> {
+    using zmm_t = typename vtype::zmm_t;
+
+    static zmm_t sort_reg(zmm_t ymm)
+    {
+        ymm = cmp_merge_avx2<vtype, 0xAA>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xCC>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(0, 1, 2, 3)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xAA>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xF0>(ymm, vtype::reverse(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xCC>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xAA>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(ymm));
+        return ymm;
+    }
+    static zmm_t merge_reg(zmm_t ymm)
+    {
+        ymm = cmp_merge_avx2<vtype, 0xF0>(
+                ymm,
+                vtype::permutexvar(_mm256_set_epi32(NETWORK_AVX2_32BIT_2),
+                                   ymm));
+        ymm = cmp_merge_avx2<vtype, 0xCC>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xAA>(
+                ymm, vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(ymm));
+        return ymm;
+    }
+};
+
+template <>
+void avx2_qsort<int32_t>(int32_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_avx2_<avx2_vector<int32_t>>(
+                arr, 0, arrsize - 1)) {
+        qsort_avx2_<avx2_vector<int32_t>, int32_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qsort<uint32_t>(uint32_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_avx2_<avx2_vector<uint32_t>>(
+                arr, 0, arrsize - 1)) {
+        qsort_avx2_<avx2_vector<uint32_t>, uint32_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qsort<float>(float *arr, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        int64_t nan_count
+                = replace_nan_with_inf_avx2<avx2_vector<float>>(arr, arrsize);
+        if (!sort_if_structured_avx2_<avx2_vector<float>>(
+                    arr, 0, arrsize - 1)) {
+            qsort_avx2_<avx2_vector<float>, float>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+        replace_inf_with_nan_avx2(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx2_qselect<int32_t>(int32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_avx2_<avx2_vector<int32_t>, int32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qselect<uint32_t>(uint32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_avx2_<avx2_vector<uint32_t>, uint32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qselect<float>(float *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan_avx2<avx2_vector<float>>(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_avx2_<avx2_vector<float>, float>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+#endif // AVX2_QSORT_32BIT
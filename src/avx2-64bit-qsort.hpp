@@ -0,0 +1,445 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+#ifndef AVX2_QSORT_64BIT
+#define AVX2_QSORT_64BIT
+
+#include "avx2-common-qsort.h"
+
+template <>
+struct avx2_vector<int64_t> {
+    using type_t = int64_t;
+    using zmm_t = __m256i;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 4;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_INT64;
+    }
+    static type_t type_min()
+    {
+        return X86_SIMD_SORT_MIN_INT64;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi64x(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    static zmm_t gt(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpgt_epi64(x, y);
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = gt(y, x);
+        return knot_opmask(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpeq_epi64(x, y);
+        return _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((zmm_t const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_64bit[mask]);
+        _mm256_maskstore_epi64(
+                (long long *)mem,
+                avx2_first_lanes_32bit(2 * _mm_popcnt_u32(mask)),
+                _mm256_permutevar8x32_epi32(x, perm));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_64bit(mask);
+        zmm_t y = _mm256_maskload_epi64((long long const *)mem, vmask);
+        return _mm256_blendv_epi8(x, y, vmask);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, avx2_mask_vec_64bit(mask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_epi64(
+                (long long *)mem, avx2_mask_vec_64bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, gt(x, y));
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_blendv_epi8(y, x, gt(x, y));
+    }
+    template <uint8_t mask>
+    static zmm_t permutex(zmm_t ymm)
+    {
+        return _mm256_permute4x64_epi64(ymm, mask);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutex<SHUFFLE_MASK(0, 1, 2, 3)>(ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<0x5>(v));
+        return _mm_cvtsi128_si64(_mm256_castsi256_si128(v));
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<0x5>(v));
+        return _mm_cvtsi128_si64(_mm256_castsi256_si128(v));
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi64x(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        __m256d temp = _mm256_castsi256_pd(ymm);
+        return _mm256_castpd_si256(_mm256_permute_pd(temp, mask));
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_epi32(x, y, avx2_blend_mask_64bit(mask));
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_si256((zmm_t *)mem, x);
+    }
+};
+template <>
+struct avx2_vector<uint64_t> {
+    using type_t = uint64_t;
+    using zmm_t = __m256i;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 4;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_UINT64;
+    }
+    static type_t type_min()
+    {
+        return 0;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi64x(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    /* signed comparison of the values with their top bit flipped */
+    static zmm_t gt(zmm_t x, zmm_t y)
+    {
+        const zmm_t top_bit = _mm256_set1_epi64x(X86_SIMD_SORT_MIN_INT64);
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(x, top_bit),
+                                  _mm256_xor_si256(y, top_bit));
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = gt(y, x);
+        return knot_opmask(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        zmm_t cmp = _mm256_cmpeq_epi64(x, y);
+        return _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((zmm_t const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_64bit[mask]);
+        _mm256_maskstore_epi64(
+                (long long *)mem,
+                avx2_first_lanes_32bit(2 * _mm_popcnt_u32(mask)),
+                _mm256_permutevar8x32_epi32(x, perm));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_64bit(mask);
+        zmm_t y = _mm256_maskload_epi64((long long const *)mem, vmask);
+        return _mm256_blendv_epi8(x, y, vmask);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, avx2_mask_vec_64bit(mask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_epi64(
+                (long long *)mem, avx2_mask_vec_64bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_blendv_epi8(x, y, gt(x, y));
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_blendv_epi8(y, x, gt(x, y));
+    }
+    template <uint8_t mask>
+    static zmm_t permutex(zmm_t ymm)
+    {
+        return _mm256_permute4x64_epi64(ymm, mask);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutex<SHUFFLE_MASK(0, 1, 2, 3)>(ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<0x5>(v));
+        return (type_t)_mm_cvtsi128_si64(_mm256_castsi256_si128(v));
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<0x5>(v));
+        return (type_t)_mm_cvtsi128_si64(_mm256_castsi256_si128(v));
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi64x(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        __m256d temp = _mm256_castsi256_pd(ymm);
+        return _mm256_castpd_si256(_mm256_permute_pd(temp, mask));
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_epi32(x, y, avx2_blend_mask_64bit(mask));
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_si256((zmm_t *)mem, x);
+    }
+};
+template <>
+struct avx2_vector<double> {
+    using type_t = double;
+    using zmm_t = __m256d;
+    using opmask_t = int32_t;
+    static const uint8_t numlanes = 4;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_INFINITY;
+    }
+    static type_t type_min()
+    {
+        return -X86_SIMD_SORT_INFINITY;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_pd(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_GE_OQ));
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ));
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_pd((double const *)mem);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        __m256i perm = avx2_compress_perm(avx2_compress_lut_64bit[mask]);
+        __m256 temp = _mm256_castpd_ps(x);
+        _mm256_maskstore_pd(
+                (double *)mem,
+                avx2_first_lanes_32bit(2 * _mm_popcnt_u32(mask)),
+                _mm256_castps_pd(_mm256_permutevar8x32_ps(temp, perm)));
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        __m256i vmask = avx2_mask_vec_64bit(mask);
+        zmm_t y = _mm256_maskload_pd((double const *)mem, vmask);
+        return _mm256_blendv_pd(x, y, _mm256_castsi256_pd(vmask));
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        __m256i vmask = avx2_mask_vec_64bit(mask);
+        return _mm256_blendv_pd(x, y, _mm256_castsi256_pd(vmask));
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_maskstore_pd((double *)mem, avx2_mask_vec_64bit(mask), x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_pd(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_pd(x, y);
+    }
+    template <uint8_t mask>
+    static zmm_t permutex(zmm_t ymm)
+    {
+        return _mm256_permute4x64_pd(ymm, mask);
+    }
+    static zmm_t reverse(zmm_t ymm)
+    {
+        return permutex<SHUFFLE_MASK(0, 1, 2, 3)>(ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        v = max(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = max(v, shuffle<0x5>(v));
+        return _mm256_cvtsd_f64(v);
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        v = min(v, permutex<SHUFFLE_MASK(1, 0, 3, 2)>(v));
+        v = min(v, shuffle<0x5>(v));
+        return _mm256_cvtsd_f64(v);
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_pd(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        return _mm256_permute_pd(ymm, mask);
+    }
+    template <uint8_t mask>
+    static zmm_t blend(zmm_t x, zmm_t y)
+    {
+        return _mm256_blend_pd(x, y, mask);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        _mm256_storeu_pd((double *)mem, x);
+    }
+};
+
+/*
+ * Bitonic networks of the 4 lanes of a YMM register, see the 8 lane ones in
+ * avx2-32bit-qsort.hpp
+ */
+template <typename vtype>
+struct avx2_network<vtype, 4> {
+    using zmm_t = typename vtype::zmm_t;
+
+    static zmm_t sort_reg(zmm_t ymm)
+    {
+        ymm = cmp_merge_avx2<vtype, 0xA>(ymm,
+                                         vtype::template shuffle<0x5>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xC>(ymm, vtype::reverse(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xA>(ymm,
+                                         vtype::template shuffle<0x5>(ymm));
+        return ymm;
+    }
+    static zmm_t merge_reg(zmm_t ymm)
+    {
+        ymm = cmp_merge_avx2<vtype, 0xC>(
+                ymm,
+                vtype::template permutex<SHUFFLE_MASK(1, 0, 3, 2)>(ymm));
+        ymm = cmp_merge_avx2<vtype, 0xA>(ymm,
+                                         vtype::template shuffle<0x5>(ymm));
+        return ymm;
+    }
+};
+
+template <>
+void avx2_qsort<int64_t>(int64_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_avx2_<avx2_vector<int64_t>>(
+                arr, 0, arrsize - 1)) {
+        qsort_avx2_<avx2_vector<int64_t>, int64_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qsort<uint64_t>(uint64_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_avx2_<avx2_vector<uint64_t>>(
+                arr, 0, arrsize - 1)) {
+        qsort_avx2_<avx2_vector<uint64_t>, uint64_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qsort<double>(double *arr, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        int64_t nan_count
+                = replace_nan_with_inf_avx2<avx2_vector<double>>(arr, arrsize);
+        if (!sort_if_structured_avx2_<avx2_vector<double>>(
+                    arr, 0, arrsize - 1)) {
+            qsort_avx2_<avx2_vector<double>, double>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+        replace_inf_with_nan_avx2(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx2_qselect<int64_t>(int64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_avx2_<avx2_vector<int64_t>, int64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qselect<uint64_t>(uint64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_avx2_<avx2_vector<uint64_t>, uint64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx2_qselect<double>(double *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan_avx2<avx2_vector<double>>(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_avx2_<avx2_vector<double>, double>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+#endif // AVX2_QSORT_64BIT
@@ -0,0 +1,535 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+
+#ifndef AVX2_QSORT_COMMON
+#define AVX2_QSORT_COMMON
+
+/*
+ * Quicksort using AVX2, for the CPUs without AVX-512. avx2_vector<T> offers
+ * the interface of zmm_vector<T> on 256-bit registers, so the partitioning,
+ * presorted and merge sort routines of avx512-common-qsort.h are shared with
+ * the AVX-512 code. AVX2 has neither opmask registers nor compressstore:
+ * opmask_t is the bitmask of the lanes that movemask returns, and
+ * mask_compressstoreu moves the selected lanes to the bottom of the register
+ * with a permutation looked up by the mask before storing them with a masked
+ * store. The bitonic networks of the 32-bit and 64-bit lanes are defined in
+ * avx2-32bit-qsort.hpp and avx2-64bit-qsort.hpp. Despite its name,
+ * avx512-common-qsort.h has no AVX-512 code of its own, only macros and
+ * templates on vtype: the AVX-512 instructions are all in the zmm_vector types
+ * of the avx512-*-qsort.hpp headers, which are not included here, so the code
+ * builds with -mavx2 -mbmi2 -mpopcnt -mfma.
+ */
+
+#include "avx512-common-qsort.h"
+
+#define X86_SIMD_SORT_UNROLL_AVX2 4
+
+template <typename type>
+struct avx2_vector;
+
+/*
+ * In-register bitonic networks of vtype: sort_reg sorts one register and
+ * merge_reg sorts a register that holds a bitonic sequence. Specialized for
+ * 8 lanes in avx2-32bit-qsort.hpp and for 4 lanes in avx2-64bit-qsort.hpp.
+ */
+template <typename vtype, int numlanes = vtype::numlanes>
+struct avx2_network;
+
+template <typename T>
+void avx2_qsort(T *arr, int64_t arrsize);
+
+template <typename T>
+void avx2_qselect(T *arr, int64_t k, int64_t arrsize);
+
+/*
+ * Lane indices for mask_compressstoreu, one byte per lane: entry mask holds
+ * the lanes set in the 8-bit mask first, in order, and then the other ones
+ */
+static const uint64_t avx2_compress_lut_32bit[256] = {
+    0x0706050403020100, 0x0706050403020100, 0x0706050403020001,
+    0x0706050403020100, 0x0706050403010002, 0x0706050403010200,
+    0x0706050403000201, 0x0706050403020100, 0x0706050402010003,
+    0x0706050402010300, 0x0706050402000301, 0x0706050402030100,
+    0x0706050401000302, 0x0706050401030200, 0x0706050400030201,
+    0x0706050403020100, 0x0706050302010004, 0x0706050302010400,
+    0x0706050302000401, 0x0706050302040100, 0x0706050301000402,
+    0x0706050301040200, 0x0706050300040201, 0x0706050304020100,
+    0x0706050201000403, 0x0706050201040300, 0x0706050200040301,
+    0x0706050204030100, 0x0706050100040302, 0x0706050104030200,
+    0x0706050004030201, 0x0706050403020100, 0x0706040302010005,
+    0x0706040302010500, 0x0706040302000501, 0x0706040302050100,
+    0x0706040301000502, 0x0706040301050200, 0x0706040300050201,
+    0x0706040305020100, 0x0706040201000503, 0x0706040201050300,
+    0x0706040200050301, 0x0706040205030100, 0x0706040100050302,
+    0x0706040105030200, 0x0706040005030201, 0x0706040503020100,
+    0x0706030201000504, 0x0706030201050400, 0x0706030200050401,
+    0x0706030205040100, 0x0706030100050402, 0x0706030105040200,
+    0x0706030005040201, 0x0706030504020100, 0x0706020100050403,
+    0x0706020105040300, 0x0706020005040301, 0x0706020504030100,
+    0x0706010005040302, 0x0706010504030200, 0x0706000504030201,
+    0x0706050403020100, 0x0705040302010006, 0x0705040302010600,
+    0x0705040302000601, 0x0705040302060100, 0x0705040301000602,
+    0x0705040301060200, 0x0705040300060201, 0x0705040306020100,
+    0x0705040201000603, 0x0705040201060300, 0x0705040200060301,
+    0x0705040206030100, 0x0705040100060302, 0x0705040106030200,
+    0x0705040006030201, 0x0705040603020100, 0x0705030201000604,
+    0x0705030201060400, 0x0705030200060401, 0x0705030206040100,
+    0x0705030100060402, 0x0705030106040200, 0x0705030006040201,
+    0x0705030604020100, 0x0705020100060403, 0x0705020106040300,
+    0x0705020006040301, 0x0705020604030100, 0x0705010006040302,
+    0x0705010604030200, 0x0705000604030201, 0x0705060403020100,
+    0x0704030201000605, 0x0704030201060500, 0x0704030200060501,
+    0x0704030206050100, 0x0704030100060502, 0x0704030106050200,
+    0x0704030006050201, 0x0704030605020100, 0x0704020100060503,
+    0x0704020106050300, 0x0704020006050301, 0x0704020605030100,
+    0x0704010006050302, 0x0704010605030200, 0x0704000605030201,
+    0x0704060503020100, 0x0703020100060504, 0x0703020106050400,
+    0x0703020006050401, 0x0703020605040100, 0x0703010006050402,
+    0x0703010605040200, 0x0703000605040201, 0x0703060504020100,
+    0x0702010006050403, 0x0702010605040300, 0x0702000605040301,
+    0x0702060504030100, 0x0701000605040302, 0x0701060504030200,
+    0x0700060504030201, 0x0706050403020100, 0x0605040302010007,
+    0x0605040302010700, 0x0605040302000701, 0x0605040302070100,
+    0x0605040301000702, 0x0605040301070200, 0x0605040300070201,
+    0x0605040307020100, 0x0605040201000703, 0x0605040201070300,
+    0x0605040200070301, 0x0605040207030100, 0x0605040100070302,
+    0x0605040107030200, 0x0605040007030201, 0x0605040703020100,
+    0x0605030201000704, 0x0605030201070400, 0x0605030200070401,
+    0x0605030207040100, 0x0605030100070402, 0x0605030107040200,
+    0x0605030007040201, 0x0605030704020100, 0x0605020100070403,
+    0x0605020107040300, 0x0605020007040301, 0x0605020704030100,
+    0x0605010007040302, 0x0605010704030200, 0x0605000704030201,
+    0x0605070403020100, 0x0604030201000705, 0x0604030201070500,
+    0x0604030200070501, 0x0604030207050100, 0x0604030100070502,
+    0x0604030107050200, 0x0604030007050201, 0x0604030705020100,
+    0x0604020100070503, 0x0604020107050300, 0x0604020007050301,
+    0x0604020705030100, 0x0604010007050302, 0x0604010705030200,
+    0x0604000705030201, 0x0604070503020100, 0x0603020100070504,
+    0x0603020107050400, 0x0603020007050401, 0x0603020705040100,
+    0x0603010007050402, 0x0603010705040200, 0x0603000705040201,
+    0x0603070504020100, 0x0602010007050403, 0x0602010705040300,
+    0x0602000705040301, 0x0602070504030100, 0x0601000705040302,
+    0x0601070504030200, 0x0600070504030201, 0x0607050403020100,
+    0x0504030201000706, 0x0504030201070600, 0x0504030200070601,
+    0x0504030207060100, 0x0504030100070602, 0x0504030107060200,
+    0x0504030007060201, 0x0504030706020100, 0x0504020100070603,
+    0x0504020107060300, 0x0504020007060301, 0x0504020706030100,
+    0x0504010007060302, 0x0504010706030200, 0x0504000706030201,
+    0x0504070603020100, 0x0503020100070604, 0x0503020107060400,
+    0x0503020007060401, 0x0503020706040100, 0x0503010007060402,
+    0x0503010706040200, 0x0503000706040201, 0x0503070604020100,
+    0x0502010007060403, 0x0502010706040300, 0x0502000706040301,
+    0x0502070604030100, 0x0501000706040302, 0x0501070604030200,
+    0x0500070604030201, 0x0507060403020100, 0x0403020100070605,
+    0x0403020107060500, 0x0403020007060501, 0x0403020706050100,
+    0x0403010007060502, 0x0403010706050200, 0x0403000706050201,
+    0x0403070605020100, 0x0402010007060503, 0x0402010706050300,
+    0x0402000706050301, 0x0402070605030100, 0x0401000706050302,
+    0x0401070605030200, 0x0400070605030201, 0x0407060503020100,
+    0x0302010007060504, 0x0302010706050400, 0x0302000706050401,
+    0x0302070605040100, 0x0301000706050402, 0x0301070605040200,
+    0x0300070605040201, 0x0307060504020100, 0x0201000706050403,
+    0x0201070605040300, 0x0200070605040301, 0x0207060504030100,
+    0x0100070605040302, 0x0107060504030200, 0x0007060504030201,
+    0x0706050403020100,
+};
+
+/*
+ * Same for the 4-bit masks of the 64-bit lanes, as pairs of 32-bit lanes
+ */
+static const uint64_t avx2_compress_lut_64bit[16] = {
+    0x0706050403020100, 0x0706050403020100, 0x0706050401000302,
+    0x0706050403020100, 0x0706030201000504, 0x0706030205040100,
+    0x0706010005040302, 0x0706050403020100, 0x0504030201000706,
+    0x0504030207060100, 0x0504010007060302, 0x0504070603020100,
+    0x0302010007060504, 0x0302070605040100, 0x0100070605040302,
+    0x0706050403020100,
+};
+
+/*
+ * Eight 32-bit lanes loaded at avx2_prefix_mask + 8 - n are the mask of the
+ * first n of them
+ */
+static const int32_t avx2_prefix_mask[16]
+        = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+
+X86_SIMD_SORT_INLINE __m256i avx2_compress_perm(uint64_t lut_entry)
+{
+    return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((int64_t)lut_entry));
+}
+
+X86_SIMD_SORT_INLINE __m256i avx2_first_lanes_32bit(int32_t n)
+{
+    return _mm256_loadu_si256((__m256i const *)(avx2_prefix_mask + 8 - n));
+}
+
+/*
+ * Vector masks of the lanes set in an opmask_t of avx2_vector
+ */
+X86_SIMD_SORT_INLINE __m256i avx2_mask_vec_32bit(int32_t mask)
+{
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(
+            _mm256_and_si256(_mm256_set1_epi32(mask), bits), bits);
+}
+
+X86_SIMD_SORT_INLINE __m256i avx2_mask_vec_64bit(int32_t mask)
+{
+    const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+    return _mm256_cmpeq_epi64(
+            _mm256_and_si256(_mm256_set1_epi64x(mask), bits), bits);
+}
+
+/*
+ * _mm256_blend_epi32 mask that selects the 64-bit lanes set in mask
+ */
+constexpr int avx2_blend_mask_64bit(int mask)
+{
+    return ((mask & 1) ? 0x03 : 0) | ((mask & 2) ? 0x0C : 0)
+            | ((mask & 4) ? 0x30 : 0) | ((mask & 8) ? 0xC0 : 0);
+}
+
+/*
+ * cmp_merge with a constant mask, which AVX2 can only apply as an immediate
+ */
+template <typename vtype, uint8_t mask, typename zmm_t>
+X86_SIMD_SORT_INLINE zmm_t cmp_merge_avx2(zmm_t in1, zmm_t in2)
+{
+    zmm_t min = vtype::min(in2, in1);
+    zmm_t max = vtype::max(in2, in1);
+    return vtype::template blend<mask>(min, max); // 0 -> min, 1 -> max
+}
+
+/*
+ * Compares and exchanges two registers. min and max return their second
+ * operand when both compare equal, so they take them in opposite orders: a
+ * pair of equal values, such as -0.0 and 0.0, is swapped rather than
+ * duplicated.
+ */
+template <typename vtype, typename zmm_t>
+X86_SIMD_SORT_INLINE void coex_avx2(zmm_t &a, zmm_t &b)
+{
+    zmm_t temp = a;
+    a = vtype::min(a, b);
+    b = vtype::max(b, temp);
+}
+
+/*
+ * Sorts regs[0, numregs) as one sequence, regs[0] ending up with the
+ * smallest elements. Runs of registers are merged with the flip variant of
+ * the bitonic merge: its first step compares every element of a run with the
+ * mirror image of it in the other run, so that neither run has to be sorted
+ * in reverse.
+ */
+template <typename vtype, int numregs>
+X86_SIMD_SORT_INLINE void bitonic_sort_regs_avx2(typename vtype::zmm_t *regs)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using network = avx2_network<vtype>;
+    for (int ii = 0; ii < numregs; ++ii) {
+        regs[ii] = network::sort_reg(regs[ii]);
+    }
+    for (int width = 1; width < numregs; width *= 2) {
+        for (int base = 0; base < numregs; base += 2 * width) {
+            zmm_t *run = regs + base;
+            for (int ii = 0; ii < width; ++ii) {
+                zmm_t mirror = vtype::reverse(run[2 * width - 1 - ii]);
+                coex_avx2<vtype>(run[ii], mirror);
+                run[2 * width - 1 - ii] = vtype::reverse(mirror);
+            }
+            for (int dist = width / 2; dist > 0; dist /= 2) {
+                for (int ii = 0; ii < 2 * width; ++ii) {
+                    if ((ii & dist) == 0) {
+                        coex_avx2<vtype>(run[ii], run[ii + dist]);
+                    }
+                }
+            }
+        }
+        for (int ii = 0; ii < numregs; ++ii) {
+            regs[ii] = network::merge_reg(regs[ii]);
+        }
+    }
+}
+
+/*
+ * Sorts arr[0, N) for N <= numregs * vtype::numlanes, padding the registers
+ * past N with vtype::type_max()
+ */
+template <typename vtype, int numregs, typename type_t>
+X86_SIMD_SORT_INLINE void sort_regs_avx2_(type_t *arr, int32_t N)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    zmm_t regs[numregs];
+    for (int ii = 0; ii < numregs; ++ii) {
+        int32_t lanes = N - ii * vtype::numlanes;
+        if (lanes >= vtype::numlanes) {
+            regs[ii] = vtype::loadu(arr + ii * vtype::numlanes);
+        }
+        else if (lanes > 0) {
+            regs[ii] = vtype::mask_loadu(vtype::zmm_max(),
+                                         (opmask_t)((1 << lanes) - 1),
+                                         arr + ii * vtype::numlanes);
+        }
+        else {
+            regs[ii] = vtype::zmm_max();
+        }
+    }
+    bitonic_sort_regs_avx2<vtype, numregs>(regs);
+    for (int ii = 0; ii < numregs; ++ii) {
+        int32_t lanes = N - ii * vtype::numlanes;
+        if (lanes >= vtype::numlanes) {
+            vtype::storeu(arr + ii * vtype::numlanes, regs[ii]);
+        }
+        else if (lanes > 0) {
+            vtype::mask_storeu(arr + ii * vtype::numlanes,
+                               (opmask_t)((1 << lanes) - 1),
+                               regs[ii]);
+        }
+    }
+}
+
+/*
+ * Sorts arr[0, N) for N <= maxregs * vtype::numlanes with the smallest
+ * network that holds it
+ */
+template <typename vtype, int maxregs, typename type_t>
+X86_SIMD_SORT_INLINE void sort_n_avx2(type_t *arr, int32_t N)
+{
+    if (maxregs > 1 && N <= (maxregs / 2) * vtype::numlanes) {
+        sort_n_avx2<vtype, (maxregs > 1 ? maxregs / 2 : 1)>(arr, N);
+        return;
+    }
+    sort_regs_avx2_<vtype, maxregs>(arr, N);
+}
+
+/*
+ * Sorts arr[0, N) for N <= 128, the base case of qsort_avx2_
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void sort_128_avx2(type_t *arr, int32_t N)
+{
+    sort_n_avx2<vtype, 128 / vtype::numlanes>(arr, N);
+}
+
+/*
+ * Merges two sorted registers: reg1 gets the smaller half and reg2 the larger
+ * one, both sorted
+ */
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE void bitonic_merge_two_avx2(zmm_t &reg1, zmm_t &reg2)
+{
+    zmm_t mirror = vtype::reverse(reg2);
+    coex_avx2<vtype>(reg1, mirror);
+    reg1 = avx2_network<vtype>::merge_reg(reg1);
+    reg2 = avx2_network<vtype>::merge_reg(mirror);
+}
+
+/*
+ * Pivot of qsort_avx2_: median of X86_SIMD_SORT_PIVOT_SAMPLES elements for
+ * large arrays, as in the AVX-512 code, and of 16 evenly spaced ones
+ * otherwise. *repeats tells whether the pivot occurs more than once in the
+ * sample.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_avx2_(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right,
+                                            bool *repeats)
+{
+    if (right + 1 - left >= X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD) {
+        auto sort_samples = [](type_t *samples, int32_t N) {
+            sort_128_avx2<vtype>(samples, N);
+        };
+        return get_pivot_large_(arr, left, right, sort_samples, repeats);
+    }
+    using bits_t = bits_type_t<type_t>;
+    type_t samples[16];
+    int64_t stride = (right - left) / 16;
+    for (int ii = 0; ii < 16; ++ii) {
+        samples[ii] = arr[left + (ii + 1) * stride];
+    }
+    sort_regs_avx2_<vtype, 16 / vtype::numlanes>(samples, 16);
+    bits_t pivot_bits = to_bits<bits_t>(samples[8]);
+    *repeats = to_bits<bits_t>(samples[7]) == pivot_bits
+            || to_bits<bits_t>(samples[9]) == pivot_bits;
+    return samples[8];
+}
+
+/*
+ * Fallback of qsort_avx2_ once it runs out of iterations
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+merge_sort_avx2_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto sort_block = [](type_t *block, int32_t N) {
+        sort_128_avx2<vtype>(block, N);
+    };
+    auto merge_two = [](zmm_t &reg1, zmm_t &reg2) {
+        bitonic_merge_two_avx2<vtype>(reg1, reg2);
+    };
+    merge_sort_<vtype>(arr, left, right, sort_block, merge_two);
+}
+
+/*
+ * qsort_32bit_ and qsort_64bit_ on 256-bit registers: the partitions are the
+ * AVX-512 ones, with avx2_vector as both vtype and bits vector, while the
+ * networks, the pivot and the merge sort fallback are the ones above
+ */
+template <typename vtype, typename type_t>
+static void
+qsort_avx2_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
+{
+    using bvtype = avx2_vector<bits_type_t<type_t>>;
+    /*
+     * Resort to merge sort if quicksort isnt making any progress
+     */
+    if (max_iters <= 0) {
+        merge_sort_avx2_<vtype>(arr, left, right);
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_avx2<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    bool repeats;
+    type_t pivot = get_pivot_avx2_<vtype>(arr, left, right, &repeats);
+    if (repeats) {
+        int64_t lt_end, gt_start;
+        fat_partition_avx512<vtype, bvtype>(
+                arr, left, right + 1, pivot, &lt_end, &gt_start);
+        if (lt_end - left > 1)
+            qsort_avx2_<vtype>(arr, left, lt_end - 1, max_iters - 1);
+        if (right - gt_start > 0)
+            qsort_avx2_<vtype>(arr, gt_start, right, max_iters - 1);
+        return;
+    }
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index
+            = partition_avx512_unrolled<vtype, X86_SIMD_SORT_UNROLL_AVX2>(
+                    arr, left, right + 1, pivot, &smallest, &biggest);
+    if (pivot != smallest)
+        qsort_avx2_<vtype>(arr, left, pivot_index - 1, max_iters - 1);
+    if (pivot != biggest)
+        qsort_avx2_<vtype>(arr, pivot_index, right, max_iters - 1);
+}
+
+template <typename vtype, typename type_t>
+static void qselect_avx2_(type_t *arr,
+                          int64_t pos,
+                          int64_t left,
+                          int64_t right,
+                          int64_t max_iters)
+{
+    /*
+     * Resort to std::nth_element if quickselect isnt making any progress.
+     * The comparator is a lambda so that the instantiation is local to this
+     * translation unit: with comparison_func<vtype> it would be shared with
+     * the AVX-512 code, and the linker may keep either copy.
+     */
+    if (max_iters <= 0) {
+        std::nth_element(arr + left,
+                         arr + pos,
+                         arr + right + 1,
+                         [](const type_t &a, const type_t &b) {
+                             return comparison_func<vtype>(a, b);
+                         });
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_avx2<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    bool repeats;
+    type_t pivot = get_pivot_avx2_<vtype>(arr, left, right, &repeats);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * Only recurse into the side of the partition that contains pos
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_avx2_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_avx2_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
+/*
+ * Sorts arr[left, right] without quicksort and returns true if it is
+ * presorted or holds few distinct values, see sort_if_presorted_ and
+ * sort_if_few_unique_
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_structured_avx2_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using bvtype = avx2_vector<bits_type_t<type_t>>;
+    auto merge_two = [](zmm_t &reg1, zmm_t &reg2) {
+        bitonic_merge_two_avx2<vtype>(reg1, reg2);
+    };
+    return sort_if_presorted_<vtype>(arr, left, right, merge_two)
+            || sort_if_few_unique_<vtype, bvtype>(arr, left, right);
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE bool has_nan_avx2(const type_t *arr, int64_t arrsize)
+{
+    int64_t ii = 0;
+    for (; ii + vtype::numlanes <= arrsize; ii += vtype::numlanes) {
+        typename vtype::zmm_t reg = vtype::loadu(arr + ii);
+        if (vtype::knot_opmask(vtype::eq(reg, reg)) != 0) { return true; }
+    }
+    for (; ii < arrsize; ++ii) {
+        if (is_a_nan(arr[ii])) { return true; }
+    }
+    return false;
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf_avx2(type_t *arr,
+                                                       int64_t arrsize)
+{
+    using opmask_t = typename vtype::opmask_t;
+    int64_t nan_count = 0;
+    int64_t ii = 0;
+    for (; ii + vtype::numlanes <= arrsize; ii += vtype::numlanes) {
+        typename vtype::zmm_t reg = vtype::loadu(arr + ii);
+        opmask_t nanmask = vtype::knot_opmask(vtype::eq(reg, reg));
+        if (nanmask != 0) {
+            nan_count += _mm_popcnt_u32((int32_t)nanmask);
+            vtype::mask_storeu(arr + ii, nanmask, vtype::zmm_max());
+        }
+    }
+    for (; ii < arrsize; ++ii) {
+        if (is_a_nan(arr[ii])) {
+            arr[ii] = vtype::type_max();
+            nan_count += 1;
+        }
+    }
+    return nan_count;
+}
+
+template <typename type_t>
+X86_SIMD_SORT_INLINE void
+replace_inf_with_nan_avx2(type_t *arr, int64_t arrsize, int64_t nan_count)
+{
+    std::fill(arr + arrsize - nan_count,
+              arr + arrsize,
+              std::numeric_limits<type_t>::quiet_NaN());
+}
+#endif // AVX2_QSORT_COMMON
@@ -8,6 +8,7 @@
 #define AVX512_QSORT_16BIT
 
 #include "avx512-common-qsort.h"
+#include <vector>
 
 /*
  * Constants used in sorting 32 elements in a ZMM registers. Based on Bitonic
@@ -126,6 +127,10 @@ struct zmm_vector<float16> {
     {
         return _mm512_permutexvar_epi16(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(get_network(4), zmm);
+    }
     // Apparently this is a terrible for perf, npy_half_to_float seems to work
     // better
     //static float uint16_to_float(uint16_t val)
@@ -207,6 +212,10 @@ struct zmm_vector<int16_t> {
     {
         return _mm512_cmp_epi16_mask(x, y, _MM_CMPINT_NLT);
     }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm512_cmp_epi16_mask(x, y, _MM_CMPINT_EQ);
+    }
     static zmm_t loadu(void const *mem)
     {
         return _mm512_loadu_si512(mem);
@@ -241,6 +250,10 @@ struct zmm_vector<int16_t> {
     {
         return _mm512_permutexvar_epi16(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(get_network(4), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         zmm_t lo = _mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(v, 0));
@@ -305,6 +318,10 @@ struct zmm_vector<uint16_t> {
     {
         return _mm512_cmp_epu16_mask(x, y, _MM_CMPINT_NLT);
     }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm512_cmp_epu16_mask(x, y, _MM_CMPINT_EQ);
+    }
     static zmm_t loadu(void const *mem)
     {
         return _mm512_loadu_si512(mem);
@@ -337,6 +354,10 @@ struct zmm_vector<uint16_t> {
     {
         return _mm512_permutexvar_epi16(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(get_network(4), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         zmm_t lo = _mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(v, 0));
@@ -555,12 +576,15 @@ X86_SIMD_SORT_INLINE void sort_128_16bit(type_t *arr, int32_t N)
     vtype::mask_storeu(arr + 96, load_mask2, zmm[3]);
 }
 
+/*
+ * Picks 32 evenly spaced elements of arr[left, right] and returns them
+ * sorted: the pivot is their median
+ */
 template <typename vtype, typename type_t>
-X86_SIMD_SORT_INLINE type_t get_pivot_16bit(type_t *arr,
-                                            const int64_t left,
-                                            const int64_t right)
+X86_SIMD_SORT_INLINE __m512i get_pivot_sample_16bit(type_t *arr,
+                                                    const int64_t left,
+                                                    const int64_t right)
 {
-    // median of 32
     int64_t size = (right - left) / 32;
     type_t vec_arr[32] = {arr[left],
                           arr[left + size],
@@ -595,8 +619,42 @@ X86_SIMD_SORT_INLINE type_t get_pivot_16bit(type_t *arr,
                           arr[left + 30 * size],
                           arr[left + 31 * size]};
     __m512i rand_vec = _mm512_loadu_si512(vec_arr);
-    __m512i sort = sort_zmm_16bit<vtype>(rand_vec);
-    return ((type_t *)&sort)[16];
+    return sort_zmm_16bit<vtype>(rand_vec);
+}
+
+/*
+ * Pivot of qsort_16bit_: median of X86_SIMD_SORT_PIVOT_SAMPLES elements
+ * for large arrays and of 32 otherwise. *repeats tells whether the pivot
+ * occurs more than once in the sample.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_16bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right,
+                                            bool *repeats)
+{
+    if (right + 1 - left >= X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD) {
+        auto sort_samples = [](type_t *samples, int32_t N) {
+            sort_128_16bit<vtype>(samples, N);
+        };
+        return get_pivot_large_(arr, left, right, sort_samples, repeats);
+    }
+    __m512i sort = get_pivot_sample_16bit<vtype>(arr, left, right);
+    type_t pivot = ((type_t *)&sort)[16];
+    *repeats = pivot_repeats(sort, pivot);
+    return pivot;
+}
+
+/*
+ * Same pivot, for the callers that always partition two ways
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_16bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right)
+{
+    bool repeats;
+    return get_pivot_16bit<vtype>(arr, left, right, &repeats);
 }
 
 template <>
@@ -627,15 +685,33 @@ bool comparison_func<zmm_vector<float16>>(const uint16_t &a, const uint16_t &b)
     //return npy_half_to_float(a) < npy_half_to_float(b);
 }
 
+/*
+ * Fallback of qsort_16bit_ once it runs out of iterations: merge_sort_ with
+ * the 16-bit bitonic networks
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+merge_sort_16bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto sort_block = [](type_t *block, int32_t N) {
+        sort_128_16bit<vtype>(block, N);
+    };
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_16bit<vtype>(zmm1, zmm2);
+    };
+    merge_sort_<vtype>(arr, left, right, sort_block, merge_two);
+}
+
 template <typename vtype, typename type_t>
 static void
 qsort_16bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
 {
     /*
-     * Resort to std::sort if quicksort isnt making any progress
+     * Resort to merge sort if quicksort isnt making any progress
      */
     if (max_iters <= 0) {
-        std::sort(arr + left, arr + right + 1, comparison_func<vtype>);
+        merge_sort_16bit_<vtype>(arr, left, right);
         return;
     }
     /*
@@ -646,17 +722,140 @@ qsort_16bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
         return;
     }
 
-    type_t pivot = get_pivot_16bit<vtype>(arr, left, right);
+    bool repeats;
+    type_t pivot = get_pivot_16bit<vtype>(arr, left, right, &repeats);
+    /*
+     * Many copies of the pivot: split off the elements equal to it, which
+     * are in place, and only recurse on both sides
+     */
+    if (repeats) {
+        int64_t lt_end, gt_start;
+        fat_partition_avx512<vtype>(
+                arr, left, right + 1, pivot, &lt_end, &gt_start);
+        if (lt_end - left > 1)
+            qsort_16bit_<vtype>(arr, left, lt_end - 1, max_iters - 1);
+        if (right - gt_start > 0)
+            qsort_16bit_<vtype>(arr, gt_start, right, max_iters - 1);
+        return;
+    }
     type_t smallest = vtype::type_max();
     type_t biggest = vtype::type_min();
-    int64_t pivot_index = partition_avx512<vtype>(
-            arr, left, right + 1, pivot, &smallest, &biggest);
+    int64_t pivot_index
+            = partition_avx512_unrolled<vtype, X86_SIMD_SORT_UNROLL_16BIT>(
+                    arr, left, right + 1, pivot, &smallest, &biggest);
     if (pivot != smallest)
         qsort_16bit_<vtype>(arr, left, pivot_index - 1, max_iters - 1);
     if (pivot != biggest)
         qsort_16bit_<vtype>(arr, pivot_index, right, max_iters - 1);
 }
 
+/*
+ * Segments that fit in the bitonic networks go to them directly, without the
+ * max_iters setup and the call overhead of avx512_qsort.
+ */
+template <typename vtype, typename type_t>
+static void segmented_sort_16bit_(type_t *data,
+                                  const int64_t *offsets,
+                                  int64_t nsegments)
+{
+    for (int64_t ii = 0; ii < nsegments; ++ii) {
+        type_t *arr = data + offsets[ii];
+        int64_t arrsize = offsets[ii + 1] - offsets[ii];
+        if (arrsize <= 1) { continue; }
+        if (arrsize <= 128) {
+            sort_128_16bit<vtype>(arr, (int32_t)arrsize);
+        }
+        else {
+            qsort_16bit_<vtype>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+    }
+}
+
+template <typename vtype, typename type_t>
+static void qselect_16bit_(type_t *arr,
+                           int64_t pos,
+                           int64_t left,
+                           int64_t right,
+                           int64_t max_iters)
+{
+    /*
+     * Resort to std::nth_element if quickselect isnt making any progress,
+     * with a lambda as in qselect_avx2_
+     */
+    if (max_iters <= 0) {
+        std::nth_element(arr + left,
+                         arr + pos,
+                         arr + right + 1,
+                         [](const type_t &a, const type_t &b) {
+                             return comparison_func<vtype>(a, b);
+                         });
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_16bit<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_16bit<vtype>(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * Only recurse into the side of the partition that contains pos
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_16bit_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_16bit_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
+/*
+ * Sorts arr[left, right] without quicksort and returns true if it is presorted
+ * (sort_if_presorted_, merging runs with the 16-bit bitonic network) or holds
+ * few distinct values (sort_if_few_unique_)
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_structured_16bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_16bit<vtype>(zmm1, zmm2);
+    };
+    return sort_if_presorted_<vtype>(arr, left, right, merge_two)
+            || sort_if_few_unique_<vtype>(arr, left, right);
+}
+
+X86_SIMD_SORT_INLINE bool has_nan(uint16_t *arr, int64_t arrsize)
+{
+    __mmask16 loadmask = 0xFFFF;
+    while (arrsize > 0) {
+        if (arrsize < 16) { loadmask = (0x0001 << arrsize) - 0x0001; }
+        __m256i in_zmm = _mm256_maskz_loadu_epi16(loadmask, arr);
+        __m512 in_zmm_asfloat = _mm512_cvtph_ps(in_zmm);
+        __mmask16 nanmask = _mm512_cmp_ps_mask(
+                in_zmm_asfloat, in_zmm_asfloat, _CMP_NEQ_UQ);
+        if (nanmask != 0x0000) { return true; }
+        arr += 16;
+        arrsize -= 16;
+    }
+    return false;
+}
+
+/*
+ * uint16_t arrays are only checked for NAN's when they hold float16 values
+ */
+template <>
+inline bool is_a_nan<uint16_t>(uint16_t elem)
+{
+    return ((elem & 0x7c00) == 0x7c00) && ((elem & 0x03ff) != 0);
+}
+
 X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf(uint16_t *arr,
                                                   int64_t arrsize)
 {
@@ -685,10 +884,182 @@ replace_inf_with_nan(uint16_t *arr, int64_t arrsize, int64_t nan_count)
     }
 }
 
+/*
+ * 16-bit keys can only take 65536 values, so big arrays are sorted with a
+ * counting sort: one pass to build a histogram of the bit patterns and one
+ * pass to write every value back as many times as it occurs. With fewer
+ * elements than bins, clearing and scanning the histogram costs more than the
+ * quicksort.
+ */
+#define X86_SIMD_SORT_COUNTING_SORT_THRESHOLD 65536
+
+X86_SIMD_SORT_INLINE void
+histogram_16bit(const uint16_t *arr, int64_t arrsize, uint32_t *counts)
+{
+    for (int64_t ii = 0; ii < arrsize; ++ii) {
+        counts[arr[ii]]++;
+    }
+}
+
+/*
+ * Writes count copies of val at arr[pos]. The first 32 are written with a
+ * single unmasked store whenever it stays inside the array: lanes past count
+ * are overwritten by the next value.
+ */
+X86_SIMD_SORT_INLINE void fill_run_16bit(uint16_t *arr,
+                                         int64_t &pos,
+                                         int64_t arrsize,
+                                         uint16_t val,
+                                         int64_t count)
+{
+    __m512i zmm = _mm512_set1_epi16(val);
+    int64_t end = pos + count;
+    if (pos + 32 <= arrsize) {
+        _mm512_storeu_si512(arr + pos, zmm);
+        pos += 32;
+    }
+    for (; pos + 32 <= end; pos += 32) {
+        _mm512_storeu_si512(arr + pos, zmm);
+    }
+    if (pos < end) {
+        __mmask32 mask = (__mmask32)((1ull << (end - pos)) - 1);
+        _mm512_mask_storeu_epi16(arr + pos, mask, zmm);
+    }
+    pos = end;
+}
+
+/*
+ * Writes the values of the bins in [first, last) back to arr[pos], in
+ * increasing order of the bins or in decreasing order if descending. Empty
+ * bins are skipped 16 at a time.
+ */
+template <bool descending>
+X86_SIMD_SORT_INLINE void fill_bins_16bit(uint16_t *arr,
+                                          int64_t &pos,
+                                          int64_t arrsize,
+                                          const uint32_t *counts,
+                                          int32_t first,
+                                          int32_t last)
+{
+    for (int32_t ii = 0; ii < (1 << 16); ii += 16) {
+        int32_t block = descending ? (1 << 16) - 16 - ii : ii;
+        if (block + 16 <= first || block >= last) { continue; }
+        __m512i zmm = _mm512_loadu_si512(counts + block);
+        __mmask16 nonzero = _mm512_test_epi32_mask(zmm, zmm);
+        if (block < first) {
+            nonzero &= (__mmask16)(0xFFFF << (first - block));
+        }
+        if (block + 16 > last) {
+            nonzero &= (__mmask16)(0xFFFF >> (block + 16 - last));
+        }
+        while (nonzero) {
+            int32_t lane = descending ? 31 - __builtin_clz(nonzero)
+                                      : __builtin_ctz(nonzero);
+            fill_run_16bit(arr,
+                           pos,
+                           arrsize,
+                           (uint16_t)(block + lane),
+                           counts[block + lane]);
+            nonzero &= ~(__mmask16)(1 << lane);
+        }
+    }
+}
+
+/*
+ * Counting sort of the bit patterns in src, written by fill to src itself or
+ * to another array. Signed values and float16 values are handled by the order
+ * in which the caller fills the bins.
+ */
+template <typename fill_t>
+X86_SIMD_SORT_INLINE void
+counting_sort_16bit(const uint16_t *src, int64_t arrsize, fill_t fill)
+{
+    std::vector<uint32_t> counts(1 << 16, 0);
+    histogram_16bit(src, arrsize, counts.data());
+    int64_t pos = 0;
+    fill(counts.data(), pos);
+}
+
+X86_SIMD_SORT_INLINE bool use_counting_sort_16bit(int64_t arrsize)
+{
+    return arrsize >= X86_SIMD_SORT_COUNTING_SORT_THRESHOLD
+            && arrsize <= (int64_t)X86_SIMD_SORT_MAX_UINT32;
+}
+
+X86_SIMD_SORT_INLINE void counting_sort_int16(const int16_t *src,
+                                              int16_t *arr,
+                                              int64_t arrsize,
+                                              bool descending)
+{
+    uint16_t *arru = (uint16_t *)arr;
+    const uint16_t *srcu = (const uint16_t *)src;
+    counting_sort_16bit(srcu, arrsize, [&](uint32_t *counts, int64_t &pos) {
+        if (descending) {
+            fill_bins_16bit<true>(arru, pos, arrsize, counts, 0, 0x8000);
+            fill_bins_16bit<true>(arru, pos, arrsize, counts, 0x8000, 0x10000);
+        }
+        else {
+            fill_bins_16bit<false>(arru, pos, arrsize, counts, 0x8000, 0x10000);
+            fill_bins_16bit<false>(arru, pos, arrsize, counts, 0, 0x8000);
+        }
+    });
+}
+
+X86_SIMD_SORT_INLINE void counting_sort_uint16(const uint16_t *src,
+                                               uint16_t *arr,
+                                               int64_t arrsize,
+                                               bool descending)
+{
+    counting_sort_16bit(src, arrsize, [&](uint32_t *counts, int64_t &pos) {
+        if (descending) {
+            fill_bins_16bit<true>(arr, pos, arrsize, counts, 0, 0x10000);
+        }
+        else {
+            fill_bins_16bit<false>(arr, pos, arrsize, counts, 0, 0x10000);
+        }
+    });
+}
+
+/*
+ * Negative float16 values sort in the reverse order of their bit patterns.
+ * In ascending order the NAN's are replaced with 0xFFFF at the end of the
+ * array, like avx512_qsort_fp16() does. In descending order they are moved to
+ * the end unmodified, like avx512_qsort_fp16_desc() does.
+ */
+X86_SIMD_SORT_INLINE void
+counting_sort_fp16(uint16_t *arr, int64_t arrsize, bool descending)
+{
+    counting_sort_16bit(arr, arrsize, [&](uint32_t *counts, int64_t &pos) {
+        const int32_t posinf = X86_SIMD_SORT_INFINITYH;
+        const int32_t neginf = X86_SIMD_SORT_NEGINFINITYH;
+        if (descending) {
+            fill_bins_16bit<true>(arr, pos, arrsize, counts, 0, posinf + 1);
+            fill_bins_16bit<false>(
+                    arr, pos, arrsize, counts, 0x8000, neginf + 1);
+            fill_bins_16bit<false>(
+                    arr, pos, arrsize, counts, posinf + 1, 0x8000);
+            fill_bins_16bit<false>(
+                    arr, pos, arrsize, counts, neginf + 1, 0x10000);
+        }
+        else {
+            fill_bins_16bit<true>(
+                    arr, pos, arrsize, counts, 0x8000, neginf + 1);
+            fill_bins_16bit<false>(arr, pos, arrsize, counts, 0, posinf + 1);
+            int64_t nan_count = arrsize - pos;
+            fill_run_16bit(arr, pos, arrsize, 0xFFFF, nan_count);
+        }
+    });
+}
+
 template <>
 void avx512_qsort(int16_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_int16(arr, arr, arrsize, false);
+    }
+    else if (arrsize > 1
+             && !sort_if_structured_16bit_<zmm_vector<int16_t>>(
+                     arr, 0, arrsize - 1)) {
         qsort_16bit_<zmm_vector<int16_t>, int16_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
@@ -697,19 +1068,209 @@ void avx512_qsort(int16_t *arr, int64_t arrsize)
 template <>
 void avx512_qsort(uint16_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_uint16(arr, arr, arrsize, false);
+    }
+    else if (arrsize > 1
+             && !sort_if_structured_16bit_<zmm_vector<uint16_t>>(
+                     arr, 0, arrsize - 1)) {
         qsort_16bit_<zmm_vector<uint16_t>, uint16_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
 }
 
+/*
+ * The counting sort reads src once for the histogram and writes dst once, so
+ * it needs no copy at all
+ */
+template <>
+inline void avx512_sort_copy(const int16_t *src, int16_t *dst, int64_t arrsize)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_int16(src, dst, arrsize, false);
+    }
+    else if (src == dst) {
+        avx512_qsort<int16_t>(dst, arrsize);
+    }
+    else {
+        sort_copy_<zmm_vector<int16_t>>(src, dst, arrsize);
+    }
+}
+
+template <>
+inline void
+avx512_sort_copy(const uint16_t *src, uint16_t *dst, int64_t arrsize)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_uint16(src, dst, arrsize, false);
+    }
+    else if (src == dst) {
+        avx512_qsort<uint16_t>(dst, arrsize);
+    }
+    else {
+        sort_copy_<zmm_vector<uint16_t>>(src, dst, arrsize);
+    }
+}
+
 void avx512_qsort_fp16(uint16_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_fp16(arr, arrsize, false);
+    }
+    else if (arrsize > 1) {
         int64_t nan_count = replace_nan_with_inf(arr, arrsize);
-        qsort_16bit_<zmm_vector<float16>, uint16_t>(
-                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        if (!sort_if_structured_16bit_<zmm_vector<float16>>(
+                arr, 0, arrsize - 1)) {
+            qsort_16bit_<zmm_vector<float16>, uint16_t>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
         replace_inf_with_nan(arr, arrsize, nan_count);
     }
 }
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<int16_t>>>(const int16_t &a,
+                                                       const int16_t &b)
+{
+    return comparison_func<zmm_vector<int16_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<uint16_t>>>(const uint16_t &a,
+                                                        const uint16_t &b)
+{
+    return comparison_func<zmm_vector<uint16_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<float16>>>(const uint16_t &a,
+                                                       const uint16_t &b)
+{
+    return comparison_func<zmm_vector<float16>>(b, a);
+}
+
+template <>
+void avx512_qsort_desc(int16_t *arr, int64_t arrsize)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_int16(arr, arr, arrsize, true);
+    }
+    else if (arrsize > 1
+             && !sort_if_structured_16bit_<desc_vector<zmm_vector<int16_t>>>(
+                     arr, 0, arrsize - 1)) {
+        qsort_16bit_<desc_vector<zmm_vector<int16_t>>, int16_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qsort_desc(uint16_t *arr, int64_t arrsize)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_uint16(arr, arr, arrsize, true);
+    }
+    else if (arrsize > 1
+             && !sort_if_structured_16bit_<desc_vector<zmm_vector<uint16_t>>>(
+                     arr, 0, arrsize - 1)) {
+        qsort_16bit_<desc_vector<zmm_vector<uint16_t>>, uint16_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+/*
+ * Unlike avx512_qsort_fp16(), the NAN's are moved to the end of the array and
+ * are not modified.
+ */
+void avx512_qsort_fp16_desc(uint16_t *arr, int64_t arrsize)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_fp16(arr, arrsize, true);
+        return;
+    }
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if (indx_last_elem > 0
+        && !sort_if_structured_16bit_<desc_vector<zmm_vector<float16>>>(
+                arr, 0, indx_last_elem)) {
+        qsort_16bit_<desc_vector<zmm_vector<float16>>, uint16_t>(
+                arr, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_qselect(int16_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_16bit_<zmm_vector<int16_t>, int16_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect(uint16_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_16bit_<zmm_vector<uint16_t>, uint16_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+void avx512_qselect_fp16(uint16_t *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_16bit_<zmm_vector<float16>, uint16_t>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+void avx512_partial_qsort_fp16(uint16_t *arr, int64_t k, int64_t arrsize)
+{
+    k = std::min(k, arrsize);
+    if (k > 0) {
+        avx512_qselect_fp16(arr, k - 1, arrsize);
+        avx512_qsort_fp16(arr, k - 1);
+    }
+}
+
+template <>
+void avx512_segmented_sort<int16_t>(int16_t *data,
+                                    const int64_t *offsets,
+                                    int64_t nsegments)
+{
+    segmented_sort_16bit_<zmm_vector<int16_t>>(data, offsets, nsegments);
+}
+
+template <>
+void avx512_segmented_sort<uint16_t>(uint16_t *data,
+                                     const int64_t *offsets,
+                                     int64_t nsegments)
+{
+    segmented_sort_16bit_<zmm_vector<uint16_t>>(data, offsets, nsegments);
+}
+
+/*
+ * NAN's are rare: look for them in all the segments at once and only fall
+ * back to avx512_qsort_fp16 for every segment when there are any.
+ */
+void avx512_segmented_sort_fp16(uint16_t *data,
+                                const int64_t *offsets,
+                                int64_t nsegments)
+{
+    if (nsegments <= 0) { return; }
+    if (has_nan(data + offsets[0], offsets[nsegments] - offsets[0])) {
+        for (int64_t ii = 0; ii < nsegments; ++ii) {
+            avx512_qsort_fp16(data + offsets[ii],
+                              offsets[ii + 1] - offsets[ii]);
+        }
+    }
+    else {
+        segmented_sort_16bit_<zmm_vector<float16>>(data, offsets, nsegments);
+    }
+}
 #endif // AVX512_QSORT_16BIT
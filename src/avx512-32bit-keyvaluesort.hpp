@@ -0,0 +1,537 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * Authors: Raghuveer Devulapalli <raghuveer.devulapalli@intel.com>
+ * ****************************************************************/
+
+#ifndef AVX512_QSORT_32BIT_KV
+#define AVX512_QSORT_32BIT_KV
+
+#include "avx512-32bit-qsort.hpp"
+#include "avx512-common-keyvaluesort.h"
+
+/*
+ * Key-value versions of the 32-bit bitonic networks: every permutation
+ * applied to the 16 keys of a ZMM register is also applied to the ZMM
+ * register holding their 16 values. index_type is the vtype used to move
+ * the values.
+ */
+template <typename vtype,
+          typename index_type,
+          typename zmm_t = typename vtype::zmm_t,
+          typename idx_mm_t = typename index_type::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t sort_zmm_32bit(zmm_t key_zmm, idx_mm_t &index_zmm)
+{
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(index_zmm),
+            0xAAAA);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(0, 1, 2, 3)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(0, 1, 2, 3)>(index_zmm),
+            0xCCCC);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(index_zmm),
+            0xAAAA);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::permutexvar(_mm512_set_epi32(NETWORK_32BIT_3), key_zmm),
+            index_zmm,
+            index_type::permutexvar(_mm512_set_epi32(NETWORK_32BIT_3),
+                                    index_zmm),
+            0xF0F0);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(index_zmm),
+            0xCCCC);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(index_zmm),
+            0xAAAA);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::permutexvar(_mm512_set_epi32(NETWORK_32BIT_5), key_zmm),
+            index_zmm,
+            index_type::permutexvar(_mm512_set_epi32(NETWORK_32BIT_5),
+                                    index_zmm),
+            0xFF00);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::permutexvar(_mm512_set_epi32(NETWORK_32BIT_6), key_zmm),
+            index_zmm,
+            index_type::permutexvar(_mm512_set_epi32(NETWORK_32BIT_6),
+                                    index_zmm),
+            0xF0F0);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(index_zmm),
+            0xCCCC);
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(index_zmm),
+            0xAAAA);
+    return key_zmm;
+}
+
+// Assumes zmm is bitonic and performs a recursive half cleaner
+template <typename vtype,
+          typename index_type,
+          typename zmm_t = typename vtype::zmm_t,
+          typename idx_mm_t = typename index_type::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t bitonic_merge_zmm_32bit(zmm_t key_zmm,
+                                                   idx_mm_t &index_zmm)
+{
+    // 1) half_cleaner[16]: compare 1-9, 2-10, 3-11 etc ..
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::permutexvar(_mm512_set_epi32(NETWORK_32BIT_7), key_zmm),
+            index_zmm,
+            index_type::permutexvar(_mm512_set_epi32(NETWORK_32BIT_7),
+                                    index_zmm),
+            0xFF00);
+    // 2) half_cleaner[8]: compare 1-5, 2-6, 3-7 etc ..
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::permutexvar(_mm512_set_epi32(NETWORK_32BIT_6), key_zmm),
+            index_zmm,
+            index_type::permutexvar(_mm512_set_epi32(NETWORK_32BIT_6),
+                                    index_zmm),
+            0xF0F0);
+    // 3) half_cleaner[4]
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(1, 0, 3, 2)>(index_zmm),
+            0xCCCC);
+    // 3) half_cleaner[1]
+    key_zmm = cmp_merge<vtype, index_type>(
+            key_zmm,
+            vtype::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(key_zmm),
+            index_zmm,
+            index_type::template shuffle<SHUFFLE_MASK(2, 3, 0, 1)>(index_zmm),
+            0xAAAA);
+    return key_zmm;
+}
+
+// Assumes zmm1 and zmm2 are sorted and performs a recursive half cleaner
+template <typename vtype,
+          typename index_type,
+          typename zmm_t = typename vtype::zmm_t,
+          typename idx_mm_t = typename index_type::zmm_t>
+X86_SIMD_SORT_INLINE void bitonic_merge_two_zmm_32bit(zmm_t &key_zmm1,
+                                                      zmm_t &key_zmm2,
+                                                      idx_mm_t &index_zmm1,
+                                                      idx_mm_t &index_zmm2)
+{
+    const __m512i rev_index = _mm512_set_epi32(NETWORK_32BIT_5);
+    // 1) First step of a merging network: coex of zmm1 and zmm2 reversed
+    key_zmm2 = vtype::permutexvar(rev_index, key_zmm2);
+    index_zmm2 = index_type::permutexvar(rev_index, index_zmm2);
+    COEX<vtype, index_type>(key_zmm1, key_zmm2, index_zmm1, index_zmm2);
+    // 2) Recursive half cleaner for each
+    key_zmm1 = bitonic_merge_zmm_32bit<vtype, index_type>(key_zmm1, index_zmm1);
+    key_zmm2 = bitonic_merge_zmm_32bit<vtype, index_type>(key_zmm2, index_zmm2);
+}
+
+// Assumes [zmm0, zmm1] and [zmm2, zmm3] are sorted and performs a recursive
+// half cleaner
+template <typename vtype,
+          typename index_type,
+          typename zmm_t = typename vtype::zmm_t,
+          typename idx_mm_t = typename index_type::zmm_t>
+X86_SIMD_SORT_INLINE void bitonic_merge_four_zmm_32bit(zmm_t *key_zmm,
+                                                       idx_mm_t *index_zmm)
+{
+    const __m512i rev_index = _mm512_set_epi32(NETWORK_32BIT_5);
+    zmm_t key_zmm2r = vtype::permutexvar(rev_index, key_zmm[2]);
+    zmm_t key_zmm3r = vtype::permutexvar(rev_index, key_zmm[3]);
+    idx_mm_t index_zmm2r = index_type::permutexvar(rev_index, index_zmm[2]);
+    idx_mm_t index_zmm3r = index_type::permutexvar(rev_index, index_zmm[3]);
+    COEX<vtype, index_type>(key_zmm[0], key_zmm3r, index_zmm[0], index_zmm3r);
+    COEX<vtype, index_type>(key_zmm[1], key_zmm2r, index_zmm[1], index_zmm2r);
+    key_zmm[2] = vtype::permutexvar(rev_index, key_zmm2r);
+    key_zmm[3] = vtype::permutexvar(rev_index, key_zmm3r);
+    index_zmm[2] = index_type::permutexvar(rev_index, index_zmm2r);
+    index_zmm[3] = index_type::permutexvar(rev_index, index_zmm3r);
+    COEX<vtype, index_type>(key_zmm[0], key_zmm[1], index_zmm[0], index_zmm[1]);
+    COEX<vtype, index_type>(key_zmm[2], key_zmm[3], index_zmm[2], index_zmm[3]);
+    for (int ii = 0; ii < 4; ++ii) {
+        key_zmm[ii] = bitonic_merge_zmm_32bit<vtype, index_type>(
+                key_zmm[ii], index_zmm[ii]);
+    }
+}
+
+template <typename vtype,
+          typename index_type,
+          typename zmm_t = typename vtype::zmm_t,
+          typename idx_mm_t = typename index_type::zmm_t>
+X86_SIMD_SORT_INLINE void bitonic_merge_eight_zmm_32bit(zmm_t *key_zmm,
+                                                        idx_mm_t *index_zmm)
+{
+    const __m512i rev_index = _mm512_set_epi32(NETWORK_32BIT_5);
+    zmm_t key_zmmr[4];
+    idx_mm_t index_zmmr[4];
+    for (int ii = 0; ii < 4; ++ii) {
+        key_zmmr[ii] = vtype::permutexvar(rev_index, key_zmm[7 - ii]);
+        index_zmmr[ii] = index_type::permutexvar(rev_index, index_zmm[7 - ii]);
+        COEX<vtype, index_type>(
+                key_zmm[ii], key_zmmr[ii], index_zmm[ii], index_zmmr[ii]);
+    }
+    for (int ii = 0; ii < 4; ++ii) {
+        key_zmm[7 - ii] = vtype::permutexvar(rev_index, key_zmmr[ii]);
+        index_zmm[7 - ii] = index_type::permutexvar(rev_index, index_zmmr[ii]);
+    }
+    COEX<vtype, index_type>(key_zmm[0], key_zmm[2], index_zmm[0], index_zmm[2]);
+    COEX<vtype, index_type>(key_zmm[1], key_zmm[3], index_zmm[1], index_zmm[3]);
+    COEX<vtype, index_type>(key_zmm[4], key_zmm[6], index_zmm[4], index_zmm[6]);
+    COEX<vtype, index_type>(key_zmm[5], key_zmm[7], index_zmm[5], index_zmm[7]);
+    COEX<vtype, index_type>(key_zmm[0], key_zmm[1], index_zmm[0], index_zmm[1]);
+    COEX<vtype, index_type>(key_zmm[2], key_zmm[3], index_zmm[2], index_zmm[3]);
+    COEX<vtype, index_type>(key_zmm[4], key_zmm[5], index_zmm[4], index_zmm[5]);
+    COEX<vtype, index_type>(key_zmm[6], key_zmm[7], index_zmm[6], index_zmm[7]);
+    for (int ii = 0; ii < 8; ++ii) {
+        key_zmm[ii] = bitonic_merge_zmm_32bit<vtype, index_type>(
+                key_zmm[ii], index_zmm[ii]);
+    }
+}
+
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE void
+sort_16_32bit(type_t *keys, idx_t *indexes, int32_t N)
+{
+    typename vtype::opmask_t load_mask = (0x0001 << N) - 0x0001;
+    typename vtype::zmm_t key_zmm
+            = vtype::mask_loadu(vtype::zmm_max(), load_mask, keys);
+    typename index_type::zmm_t index_zmm = index_type::mask_loadu(
+            index_type::zmm_max(), load_mask, indexes);
+    key_zmm = sort_zmm_32bit<vtype, index_type>(key_zmm, index_zmm);
+    vtype::mask_storeu(keys, load_mask, key_zmm);
+    index_type::mask_storeu(indexes, load_mask, index_zmm);
+}
+
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE void
+sort_32_32bit(type_t *keys, idx_t *indexes, int32_t N)
+{
+    if (N <= 16) {
+        sort_16_32bit<vtype, index_type>(keys, indexes, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    typename vtype::opmask_t load_mask = (0x0001 << (N - 16)) - 0x0001;
+    zmm_t key_zmm1 = vtype::loadu(keys);
+    zmm_t key_zmm2
+            = vtype::mask_loadu(vtype::zmm_max(), load_mask, keys + 16);
+    idx_mm_t index_zmm1 = index_type::loadu(indexes);
+    idx_mm_t index_zmm2 = index_type::mask_loadu(
+            index_type::zmm_max(), load_mask, indexes + 16);
+    key_zmm1 = sort_zmm_32bit<vtype, index_type>(key_zmm1, index_zmm1);
+    key_zmm2 = sort_zmm_32bit<vtype, index_type>(key_zmm2, index_zmm2);
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm1, key_zmm2, index_zmm1, index_zmm2);
+    vtype::storeu(keys, key_zmm1);
+    vtype::mask_storeu(keys + 16, load_mask, key_zmm2);
+    index_type::storeu(indexes, index_zmm1);
+    index_type::mask_storeu(indexes + 16, load_mask, index_zmm2);
+}
+
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE void
+sort_64_32bit(type_t *keys, idx_t *indexes, int32_t N)
+{
+    if (N <= 32) {
+        sort_32_32bit<vtype, index_type>(keys, indexes, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    zmm_t key_zmm[4];
+    idx_mm_t index_zmm[4];
+    opmask_t load_mask[2];
+    uint64_t combined_mask = (0x1ull << (N - 32)) - 0x1ull;
+    for (int ii = 0; ii < 2; ++ii) {
+        key_zmm[ii] = vtype::loadu(keys + 16 * ii);
+        index_zmm[ii] = index_type::loadu(indexes + 16 * ii);
+        load_mask[ii] = (combined_mask >> (16 * ii)) & 0xFFFF;
+        key_zmm[ii + 2] = vtype::mask_loadu(
+                vtype::zmm_max(), load_mask[ii], keys + 32 + 16 * ii);
+        index_zmm[ii + 2] = index_type::mask_loadu(
+                index_type::zmm_max(), load_mask[ii], indexes + 32 + 16 * ii);
+    }
+    for (int ii = 0; ii < 4; ++ii) {
+        key_zmm[ii] = sort_zmm_32bit<vtype, index_type>(key_zmm[ii],
+                                                        index_zmm[ii]);
+    }
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[0], key_zmm[1], index_zmm[0], index_zmm[1]);
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[2], key_zmm[3], index_zmm[2], index_zmm[3]);
+    bitonic_merge_four_zmm_32bit<vtype, index_type>(key_zmm, index_zmm);
+    for (int ii = 0; ii < 2; ++ii) {
+        vtype::storeu(keys + 16 * ii, key_zmm[ii]);
+        index_type::storeu(indexes + 16 * ii, index_zmm[ii]);
+        vtype::mask_storeu(keys + 32 + 16 * ii, load_mask[ii], key_zmm[ii + 2]);
+        index_type::mask_storeu(
+                indexes + 32 + 16 * ii, load_mask[ii], index_zmm[ii + 2]);
+    }
+}
+
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE void
+sort_128_32bit(type_t *keys, idx_t *indexes, int32_t N)
+{
+    if (N <= 64) {
+        sort_64_32bit<vtype, index_type>(keys, indexes, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    zmm_t key_zmm[8];
+    idx_mm_t index_zmm[8];
+    opmask_t load_mask[4];
+    uint64_t combined_mask = 0xFFFFFFFFFFFFFFFF;
+    if (N != 128) { combined_mask = (0x1ull << (N - 64)) - 0x1ull; }
+    for (int ii = 0; ii < 4; ++ii) {
+        key_zmm[ii] = vtype::loadu(keys + 16 * ii);
+        index_zmm[ii] = index_type::loadu(indexes + 16 * ii);
+        load_mask[ii] = (combined_mask >> (16 * ii)) & 0xFFFF;
+        key_zmm[ii + 4] = vtype::mask_loadu(
+                vtype::zmm_max(), load_mask[ii], keys + 64 + 16 * ii);
+        index_zmm[ii + 4] = index_type::mask_loadu(
+                index_type::zmm_max(), load_mask[ii], indexes + 64 + 16 * ii);
+    }
+    for (int ii = 0; ii < 8; ++ii) {
+        key_zmm[ii] = sort_zmm_32bit<vtype, index_type>(key_zmm[ii],
+                                                        index_zmm[ii]);
+    }
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[0], key_zmm[1], index_zmm[0], index_zmm[1]);
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[2], key_zmm[3], index_zmm[2], index_zmm[3]);
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[4], key_zmm[5], index_zmm[4], index_zmm[5]);
+    bitonic_merge_two_zmm_32bit<vtype, index_type>(
+            key_zmm[6], key_zmm[7], index_zmm[6], index_zmm[7]);
+    bitonic_merge_four_zmm_32bit<vtype, index_type>(key_zmm, index_zmm);
+    bitonic_merge_four_zmm_32bit<vtype, index_type>(key_zmm + 4,
+                                                    index_zmm + 4);
+    bitonic_merge_eight_zmm_32bit<vtype, index_type>(key_zmm, index_zmm);
+    for (int ii = 0; ii < 4; ++ii) {
+        vtype::storeu(keys + 16 * ii, key_zmm[ii]);
+        index_type::storeu(indexes + 16 * ii, index_zmm[ii]);
+        vtype::mask_storeu(keys + 64 + 16 * ii, load_mask[ii], key_zmm[ii + 4]);
+        index_type::mask_storeu(
+                indexes + 64 + 16 * ii, load_mask[ii], index_zmm[ii + 4]);
+    }
+}
+
+/*
+ * Fallback of the key-value qsort_32bit_ once it runs out of iterations:
+ * merge_sort_ with the 32-bit key-value bitonic networks
+ */
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE void
+merge_sort_32bit_(type_t *keys, idx_t *indexes, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    auto sort_block = [](type_t *block_keys, idx_t *block_indexes, int32_t N) {
+        sort_128_32bit<vtype, index_type>(block_keys, block_indexes, N);
+    };
+    auto merge_two = [](zmm_t &key_zmm1,
+                        zmm_t &key_zmm2,
+                        idx_mm_t &index_zmm1,
+                        idx_mm_t &index_zmm2) {
+        bitonic_merge_two_zmm_32bit<vtype, index_type>(
+                key_zmm1, key_zmm2, index_zmm1, index_zmm2);
+    };
+    merge_sort_<vtype, index_type>(
+            keys, indexes, left, right, sort_block, merge_two);
+}
+
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+static void qsort_32bit_(type_t *keys,
+                         idx_t *indexes,
+                         int64_t left,
+                         int64_t right,
+                         int64_t max_iters)
+{
+    /*
+     * Resort to merge sort if quicksort isnt making any progress
+     */
+    if (max_iters <= 0) {
+        merge_sort_32bit_<vtype, index_type>(keys, indexes, left, right);
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_32bit<vtype, index_type>(
+                keys + left, indexes + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_32bit<vtype>(keys, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512_unrolled<vtype,
+                                                    X86_SIMD_SORT_UNROLL_KV,
+                                                    index_type>(
+            keys, indexes, left, right + 1, pivot, &smallest, &biggest);
+    if (pivot != smallest) {
+        qsort_32bit_<vtype, index_type>(
+                keys, indexes, left, pivot_index - 1, max_iters - 1);
+    }
+    if (pivot != biggest) {
+        qsort_32bit_<vtype, index_type>(
+                keys, indexes, pivot_index, right, max_iters - 1);
+    }
+}
+
+/*
+ * Values are only ever moved around, so int32_t, uint32_t and float values
+ * are all handled as uint32_t in the vector registers.
+ */
+template <typename vtype, typename type_t, typename idx_t>
+X86_SIMD_SORT_INLINE void
+qsort_kv_32bit(type_t *keys, idx_t *indexes, int64_t arrsize)
+{
+    static_assert(sizeof(idx_t) == sizeof(uint32_t),
+                  "values must be 32-bit wide");
+    if (sort_kv_if_few_unique_<vtype, zmm_vector<uint32_t>>(
+                keys, indexes, arrsize)) {
+        return;
+    }
+    int64_t indx_last_elem
+            = move_max_to_end_of_array<vtype>(keys, indexes, arrsize);
+    if (indx_last_elem > 0) {
+        qsort_32bit_<vtype, zmm_vector<uint32_t>>(
+                keys,
+                indexes,
+                0,
+                indx_last_elem,
+                2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_qsort_kv<int32_t, uint32_t>(int32_t *keys,
+                                        uint32_t *indexes,
+                                        int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<int32_t>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<int32_t, int32_t>(int32_t *keys,
+                                       int32_t *indexes,
+                                       int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<int32_t>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<int32_t, float>(int32_t *keys,
+                                     float *indexes,
+                                     int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<int32_t>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<uint32_t, uint32_t>(uint32_t *keys,
+                                         uint32_t *indexes,
+                                         int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<uint32_t>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<uint32_t, int32_t>(uint32_t *keys,
+                                        int32_t *indexes,
+                                        int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<uint32_t>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<uint32_t, float>(uint32_t *keys,
+                                      float *indexes,
+                                      int64_t arrsize)
+{
+    qsort_kv_32bit<zmm_vector<uint32_t>>(keys, indexes, arrsize);
+}
+
+/*
+ * Unlike avx512_qsort<float>, the NAN keys are moved to the end of the array
+ * along with their values and are not modified.
+ */
+template <>
+void avx512_qsort_kv<float, uint32_t>(float *keys,
+                                      uint32_t *indexes,
+                                      int64_t arrsize)
+{
+    if (has_nan(keys, arrsize)) {
+        arrsize = move_nans_to_end_of_array(keys, indexes, arrsize) + 1;
+    }
+    qsort_kv_32bit<zmm_vector<float>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<float, int32_t>(float *keys,
+                                     int32_t *indexes,
+                                     int64_t arrsize)
+{
+    if (has_nan(keys, arrsize)) {
+        arrsize = move_nans_to_end_of_array(keys, indexes, arrsize) + 1;
+    }
+    qsort_kv_32bit<zmm_vector<float>>(keys, indexes, arrsize);
+}
+
+template <>
+void avx512_qsort_kv<float, float>(float *keys, float *indexes, int64_t arrsize)
+{
+    if (has_nan(keys, arrsize)) {
+        arrsize = move_nans_to_end_of_array(keys, indexes, arrsize) + 1;
+    }
+    qsort_kv_32bit<zmm_vector<float>>(keys, indexes, arrsize);
+}
+#endif // AVX512_QSORT_32BIT_KV
@@ -52,6 +52,10 @@ struct zmm_vector<int32_t> {
     {
         return _mm512_cmp_epi32_mask(x, y, _MM_CMPINT_NLT);
     }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm512_cmp_epi32_mask(x, y, _MM_CMPINT_EQ);
+    }
     template <int scale>
     static ymm_t i64gather(__m512i index, void const *base)
     {
@@ -94,6 +98,10 @@ struct zmm_vector<int32_t> {
     {
         return _mm512_permutexvar_epi32(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi32(NETWORK_32BIT_5), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_epi32(v);
@@ -164,6 +172,10 @@ struct zmm_vector<uint32_t> {
     {
         return _mm512_cmp_epu32_mask(x, y, _MM_CMPINT_NLT);
     }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm512_cmp_epu32_mask(x, y, _MM_CMPINT_EQ);
+    }
     static zmm_t loadu(void const *mem)
     {
         return _mm512_loadu_si512(mem);
@@ -196,6 +208,10 @@ struct zmm_vector<uint32_t> {
     {
         return _mm512_permutexvar_epi32(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi32(NETWORK_32BIT_5), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_epu32(v);
@@ -256,6 +272,10 @@ struct zmm_vector<float> {
     {
         return _mm512_cmp_ps_mask(x, y, _CMP_GE_OQ);
     }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm512_cmp_ps_mask(x, y, _CMP_EQ_OQ);
+    }
     template <int scale>
     static ymm_t i64gather(__m512i index, void const *base)
     {
@@ -299,6 +319,10 @@ struct zmm_vector<float> {
     {
         return _mm512_permutexvar_ps(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi32(NETWORK_32BIT_5), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_ps(v);
@@ -330,6 +354,313 @@ struct zmm_vector<float> {
         return _mm256_min_ps(x, y);
     }
 };
+/*
+ * ymm_vector holds 8 32-bit elements in a YMM register and exposes the same
+ * interface as the 8-lane zmm_vector<64-bit> types: permutexvar takes 64-bit
+ * indices and shuffle swaps adjacent elements. This lets the 32-bit dtypes
+ * reuse the 64-bit networks and partitioning that carry a ZMM register of
+ * 64-bit indices alongside the keys (see avx512-64bit-argsort.hpp).
+ */
+template <>
+struct ymm_vector<int32_t> {
+    using type_t = int32_t;
+    using zmm_t = __m256i;
+    using ymm_t = __m256i;
+    using opmask_t = __mmask8;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_INT32;
+    }
+    static type_t type_min()
+    {
+        return X86_SIMD_SORT_MIN_INT32;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi32(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return _knot_mask8(x);
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_epi32_mask(x, y, _MM_CMPINT_NLT);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_epi32_mask(x, y, _MM_CMPINT_EQ);
+    }
+    template <int scale>
+    static zmm_t i64gather(__m512i index, void const *base)
+    {
+        return _mm512_i64gather_epi32(index, base, scale);
+    }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_epi32(src, mask, index, base, scale);
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((__m256i const *)mem);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epi32(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_compressstoreu_epi32(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi32(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi32(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_storeu_epi32(mem, mask, x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epi32(x, y);
+    }
+    static zmm_t permutexvar(__m512i idx, zmm_t ymm)
+    {
+        return _mm256_permutexvar_epi32(_mm512_cvtepi64_epi32(idx), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        return _mm512_mask_reduce_max_epi32(0xFF, _mm512_castsi256_si512(v));
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        return _mm512_mask_reduce_min_epi32(0xFF, _mm512_castsi256_si512(v));
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        static_assert(mask == SHUFFLE_MASK(1, 1, 1, 1),
+                      "only swapping adjacent elements is supported");
+        return _mm256_shuffle_epi32(ymm, 0xB1);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        return _mm256_storeu_si256((__m256i *)mem, x);
+    }
+};
+template <>
+struct ymm_vector<uint32_t> {
+    using type_t = uint32_t;
+    using zmm_t = __m256i;
+    using ymm_t = __m256i;
+    using opmask_t = __mmask8;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_MAX_UINT32;
+    }
+    static type_t type_min()
+    {
+        return 0;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_epi32(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return _knot_mask8(x);
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_epu32_mask(x, y, _MM_CMPINT_NLT);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_epu32_mask(x, y, _MM_CMPINT_EQ);
+    }
+    template <int scale>
+    static zmm_t i64gather(__m512i index, void const *base)
+    {
+        return _mm512_i64gather_epi32(index, base, scale);
+    }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_epi32(src, mask, index, base, scale);
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_si256((__m256i const *)mem);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epu32(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_compressstoreu_epi32(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi32(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi32(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_storeu_epi32(mem, mask, x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epu32(x, y);
+    }
+    static zmm_t permutexvar(__m512i idx, zmm_t ymm)
+    {
+        return _mm256_permutexvar_epi32(_mm512_cvtepi64_epi32(idx), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        return _mm512_mask_reduce_max_epu32(0xFF, _mm512_castsi256_si512(v));
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        return _mm512_mask_reduce_min_epu32(0xFF, _mm512_castsi256_si512(v));
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        static_assert(mask == SHUFFLE_MASK(1, 1, 1, 1),
+                      "only swapping adjacent elements is supported");
+        return _mm256_shuffle_epi32(ymm, 0xB1);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        return _mm256_storeu_si256((__m256i *)mem, x);
+    }
+};
+template <>
+struct ymm_vector<float> {
+    using type_t = float;
+    using zmm_t = __m256;
+    using ymm_t = __m256;
+    using opmask_t = __mmask8;
+    static const uint8_t numlanes = 8;
+
+    static type_t type_max()
+    {
+        return X86_SIMD_SORT_INFINITYF;
+    }
+    static type_t type_min()
+    {
+        return -X86_SIMD_SORT_INFINITYF;
+    }
+    static zmm_t zmm_max()
+    {
+        return _mm256_set1_ps(type_max());
+    }
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return _knot_mask8(x);
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_ps_mask(x, y, _CMP_GE_OQ);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_ps_mask(x, y, _CMP_EQ_OQ);
+    }
+    template <int scale>
+    static zmm_t i64gather(__m512i index, void const *base)
+    {
+        return _mm512_i64gather_ps(index, base, scale);
+    }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_ps(src, mask, index, base, scale);
+    }
+    static zmm_t loadu(void const *mem)
+    {
+        return _mm256_loadu_ps((float const *)mem);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_ps(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_compressstoreu_ps(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_ps(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_ps(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        return _mm256_mask_storeu_ps(mem, mask, x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_ps(x, y);
+    }
+    static zmm_t permutexvar(__m512i idx, zmm_t ymm)
+    {
+        return _mm256_permutexvar_ps(_mm512_cvtepi64_epi32(idx), ymm);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        return _mm512_mask_reduce_max_ps(0xFF, _mm512_castps256_ps512(v));
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        return _mm512_mask_reduce_min_ps(0xFF, _mm512_castps256_ps512(v));
+    }
+    static zmm_t set1(type_t v)
+    {
+        return _mm256_set1_ps(v);
+    }
+    template <uint8_t mask>
+    static zmm_t shuffle(zmm_t ymm)
+    {
+        static_assert(mask == SHUFFLE_MASK(1, 1, 1, 1),
+                      "only swapping adjacent elements is supported");
+        return _mm256_shuffle_ps(ymm, ymm, 0xB1);
+    }
+    static void storeu(void *mem, zmm_t x)
+    {
+        return _mm256_storeu_ps((float *)mem, x);
+    }
+};
 
 /*
  * Assumes zmm is random and performs a full sorting network defined in
@@ -591,12 +922,14 @@ X86_SIMD_SORT_INLINE void sort_128_32bit(type_t *arr, int32_t N)
     vtype::mask_storeu(arr + 112, load_mask4, zmm[7]);
 }
 
+/*
+ * Gathers 16 evenly spaced elements of arr[left, right] and returns them
+ * sorted: the pivot is their median
+ */
 template <typename vtype, typename type_t>
-X86_SIMD_SORT_INLINE type_t get_pivot_32bit(type_t *arr,
-                                            const int64_t left,
-                                            const int64_t right)
+X86_SIMD_SORT_INLINE typename vtype::zmm_t
+get_pivot_sample_32bit(type_t *arr, const int64_t left, const int64_t right)
 {
-    // median of 16
     int64_t size = (right - left) / 16;
     using zmm_t = typename vtype::zmm_t;
     using ymm_t = typename vtype::ymm_t;
@@ -621,9 +954,61 @@ X86_SIMD_SORT_INLINE type_t get_pivot_32bit(type_t *arr,
     ymm_t rand_vec2
             = vtype::template i64gather<sizeof(type_t)>(rand_index2, arr);
     zmm_t rand_vec = vtype::merge(rand_vec1, rand_vec2);
-    zmm_t sort = sort_zmm_32bit<vtype>(rand_vec);
-    // pivot will never be a nan, since there are no nan's!
-    return ((type_t *)&sort)[8];
+    return sort_zmm_32bit<vtype>(rand_vec);
+}
+
+/*
+ * Pivot of qsort_32bit_: median of X86_SIMD_SORT_PIVOT_SAMPLES elements
+ * for large arrays and of 16 otherwise. *repeats tells whether the pivot
+ * occurs more than once in the sample.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_32bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right,
+                                            bool *repeats)
+{
+    if (right + 1 - left >= X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD) {
+        auto sort_samples = [](type_t *samples, int32_t N) {
+            sort_128_32bit<vtype>(samples, N);
+        };
+        return get_pivot_large_(arr, left, right, sort_samples, repeats);
+    }
+    typename vtype::zmm_t sort
+            = get_pivot_sample_32bit<vtype>(arr, left, right);
+    type_t pivot = ((type_t *)&sort)[8];
+    *repeats = pivot_repeats(sort, pivot);
+    return pivot;
+}
+
+/*
+ * Same pivot, for the callers that always partition two ways
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_32bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right)
+{
+    bool repeats;
+    return get_pivot_32bit<vtype>(arr, left, right, &repeats);
+}
+
+/*
+ * Fallback of qsort_32bit_ once it runs out of iterations: merge_sort_ with
+ * the 32-bit bitonic networks
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+merge_sort_32bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto sort_block = [](type_t *block, int32_t N) {
+        sort_128_32bit<vtype>(block, N);
+    };
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_32bit<vtype>(&zmm1, &zmm2);
+    };
+    merge_sort_<vtype>(arr, left, right, sort_block, merge_two);
 }
 
 template <typename vtype, typename type_t>
@@ -631,10 +1016,10 @@ static void
 qsort_32bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
 {
     /*
-     * Resort to std::sort if quicksort isnt making any progress
+     * Resort to merge sort if quicksort isnt making any progress
      */
     if (max_iters <= 0) {
-        std::sort(arr + left, arr + right + 1);
+        merge_sort_32bit_<vtype>(arr, left, right);
         return;
     }
     /*
@@ -645,17 +1030,129 @@ qsort_32bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
         return;
     }
 
-    type_t pivot = get_pivot_32bit<vtype>(arr, left, right);
+    bool repeats;
+    type_t pivot = get_pivot_32bit<vtype>(arr, left, right, &repeats);
+    /*
+     * Many copies of the pivot: split off the elements equal to it, which
+     * are in place, and only recurse on both sides
+     */
+    if (repeats) {
+        int64_t lt_end, gt_start;
+        fat_partition_avx512<vtype>(
+                arr, left, right + 1, pivot, &lt_end, &gt_start);
+        if (lt_end - left > 1)
+            qsort_32bit_<vtype>(arr, left, lt_end - 1, max_iters - 1);
+        if (right - gt_start > 0)
+            qsort_32bit_<vtype>(arr, gt_start, right, max_iters - 1);
+        return;
+    }
     type_t smallest = vtype::type_max();
     type_t biggest = vtype::type_min();
-    int64_t pivot_index = partition_avx512<vtype>(
-            arr, left, right + 1, pivot, &smallest, &biggest);
+    int64_t pivot_index
+            = partition_avx512_unrolled<vtype, X86_SIMD_SORT_UNROLL_32BIT>(
+                    arr, left, right + 1, pivot, &smallest, &biggest);
     if (pivot != smallest)
         qsort_32bit_<vtype>(arr, left, pivot_index - 1, max_iters - 1);
     if (pivot != biggest)
         qsort_32bit_<vtype>(arr, pivot_index, right, max_iters - 1);
 }
 
+/*
+ * Segments that fit in the bitonic networks go to them directly, without the
+ * max_iters setup and the call overhead of avx512_qsort.
+ */
+template <typename vtype, typename type_t>
+static void segmented_sort_32bit_(type_t *data,
+                                  const int64_t *offsets,
+                                  int64_t nsegments)
+{
+    for (int64_t ii = 0; ii < nsegments; ++ii) {
+        type_t *arr = data + offsets[ii];
+        int64_t arrsize = offsets[ii + 1] - offsets[ii];
+        if (arrsize <= 1) { continue; }
+        if (arrsize <= 128) {
+            sort_128_32bit<vtype>(arr, (int32_t)arrsize);
+        }
+        else {
+            qsort_32bit_<vtype>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+    }
+}
+
+template <typename vtype, typename type_t>
+static void qselect_32bit_(type_t *arr,
+                           int64_t pos,
+                           int64_t left,
+                           int64_t right,
+                           int64_t max_iters)
+{
+    /*
+     * Resort to std::nth_element if quickselect isnt making any progress,
+     * with a lambda as in qselect_avx2_
+     */
+    if (max_iters <= 0) {
+        std::nth_element(arr + left,
+                         arr + pos,
+                         arr + right + 1,
+                         [](const type_t &a, const type_t &b) {
+                             return comparison_func<vtype>(a, b);
+                         });
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_32bit<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_32bit<vtype>(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * Only recurse into the side of the partition that contains pos
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_32bit_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_32bit_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
+/*
+ * Sorts arr[left, right] without quicksort and returns true if it is presorted
+ * (sort_if_presorted_, merging runs with the 32-bit bitonic network) or holds
+ * few distinct values (sort_if_few_unique_)
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_structured_32bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_32bit<vtype>(&zmm1, &zmm2);
+    };
+    return sort_if_presorted_<vtype>(arr, left, right, merge_two)
+            || sort_if_few_unique_<vtype>(arr, left, right);
+}
+
+X86_SIMD_SORT_INLINE bool has_nan(const float *arr, int64_t arrsize)
+{
+    __mmask16 loadmask = 0xFFFF;
+    while (arrsize > 0) {
+        if (arrsize < 16) { loadmask = (0x0001 << arrsize) - 0x0001; }
+        __m512 in_zmm = _mm512_maskz_loadu_ps(loadmask, arr);
+        __mmask16 nanmask = _mm512_cmp_ps_mask(in_zmm, in_zmm, _CMP_NEQ_UQ);
+        if (nanmask != 0x0000) { return true; }
+        arr += 16;
+        arrsize -= 16;
+    }
+    return false;
+}
+
 X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf(float *arr, int64_t arrsize)
 {
     int64_t nan_count = 0;
@@ -684,7 +1181,9 @@ replace_inf_with_nan(float *arr, int64_t arrsize, int64_t nan_count)
 template <>
 void avx512_qsort<int32_t>(int32_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (arrsize > 1
+        && !sort_if_structured_32bit_<zmm_vector<int32_t>>(
+                arr, 0, arrsize - 1)) {
         qsort_32bit_<zmm_vector<int32_t>, int32_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
@@ -693,7 +1192,9 @@ void avx512_qsort<int32_t>(int32_t *arr, int64_t arrsize)
 template <>
 void avx512_qsort<uint32_t>(uint32_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (arrsize > 1
+        && !sort_if_structured_32bit_<zmm_vector<uint32_t>>(
+                arr, 0, arrsize - 1)) {
         qsort_32bit_<zmm_vector<uint32_t>, uint32_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
@@ -704,10 +1205,142 @@ void avx512_qsort<float>(float *arr, int64_t arrsize)
 {
     if (arrsize > 1) {
         int64_t nan_count = replace_nan_with_inf(arr, arrsize);
-        qsort_32bit_<zmm_vector<float>, float>(
-                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        if (!sort_if_structured_32bit_<zmm_vector<float>>(
+                arr, 0, arrsize - 1)) {
+            qsort_32bit_<zmm_vector<float>, float>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
         replace_inf_with_nan(arr, arrsize, nan_count);
     }
 }
 
+template <>
+bool comparison_func<desc_vector<zmm_vector<int32_t>>>(const int32_t &a,
+                                                       const int32_t &b)
+{
+    return comparison_func<zmm_vector<int32_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<uint32_t>>>(const uint32_t &a,
+                                                        const uint32_t &b)
+{
+    return comparison_func<zmm_vector<uint32_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<float>>>(const float &a,
+                                                     const float &b)
+{
+    return comparison_func<zmm_vector<float>>(b, a);
+}
+
+template <>
+void avx512_qsort_desc<int32_t>(int32_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_32bit_<desc_vector<zmm_vector<int32_t>>>(
+                arr, 0, arrsize - 1)) {
+        qsort_32bit_<desc_vector<zmm_vector<int32_t>>, int32_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qsort_desc<uint32_t>(uint32_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_32bit_<desc_vector<zmm_vector<uint32_t>>>(
+                arr, 0, arrsize - 1)) {
+        qsort_32bit_<desc_vector<zmm_vector<uint32_t>>, uint32_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+/*
+ * Unlike avx512_qsort<float>, the NAN's are moved to the end of the array and
+ * are not modified.
+ */
+template <>
+void avx512_qsort_desc<float>(float *arr, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if (indx_last_elem > 0
+        && !sort_if_structured_32bit_<desc_vector<zmm_vector<float>>>(
+                arr, 0, indx_last_elem)) {
+        qsort_32bit_<desc_vector<zmm_vector<float>>, float>(
+                arr, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_qselect<int32_t>(int32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_32bit_<zmm_vector<int32_t>, int32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<uint32_t>(uint32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_32bit_<zmm_vector<uint32_t>, uint32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<float>(float *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_32bit_<zmm_vector<float>, float>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_segmented_sort<int32_t>(int32_t *data,
+                                    const int64_t *offsets,
+                                    int64_t nsegments)
+{
+    segmented_sort_32bit_<zmm_vector<int32_t>>(data, offsets, nsegments);
+}
+
+template <>
+void avx512_segmented_sort<uint32_t>(uint32_t *data,
+                                     const int64_t *offsets,
+                                     int64_t nsegments)
+{
+    segmented_sort_32bit_<zmm_vector<uint32_t>>(data, offsets, nsegments);
+}
+
+/*
+ * NAN's are rare: look for them in all the segments at once and only fall
+ * back to avx512_qsort<float> for every segment when there are any.
+ */
+template <>
+void avx512_segmented_sort<float>(float *data,
+                                  const int64_t *offsets,
+                                  int64_t nsegments)
+{
+    if (nsegments <= 0) { return; }
+    if (has_nan(data + offsets[0], offsets[nsegments] - offsets[0])) {
+        for (int64_t ii = 0; ii < nsegments; ++ii) {
+            avx512_qsort<float>(data + offsets[ii],
+                                offsets[ii + 1] - offsets[ii]);
+        }
+    }
+    else {
+        segmented_sort_32bit_<zmm_vector<float>>(data, offsets, nsegments);
+    }
+}
 #endif //AVX512_QSORT_32BIT
@@ -0,0 +1,479 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * Authors: Raghuveer Devulapalli <raghuveer.devulapalli@intel.com>
+ * ****************************************************************/
+
+#ifndef AVX512_ARGSORT_64BIT
+#define AVX512_ARGSORT_64BIT
+
+#include "avx512-32bit-qsort.hpp"
+#include "avx512-64bit-keyvaluesort.hpp"
+#include <numeric>
+
+/*
+ * Argsort sorts only the index array: keys are never written to. Every
+ * vector of keys is gathered from arr using the corresponding vector of
+ * indices, partitioning moves only the indices and the key-value bitonic
+ * networks carry the indices along with the gathered keys. 32-bit dtypes use
+ * ymm_vector so that 8 keys are processed alongside 8 64-bit indices with
+ * the same code.
+ */
+using argtype = zmm_vector<int64_t>;
+using argzmm_t = typename argtype::zmm_t;
+
+template <typename T>
+X86_SIMD_SORT_INLINE void
+std_argsort(const T *arr, int64_t *arg, int64_t left, int64_t right)
+{
+    std::sort(arg + left, arg + right, [arr](int64_t a, int64_t b) -> bool {
+        return arr[a] < arr[b];
+    });
+}
+
+/*
+ * Same as std_argsort, but places the indices of all the NAN's at the end
+ */
+template <typename T>
+X86_SIMD_SORT_INLINE void
+std_argsort_withnan(const T *arr, int64_t *arg, int64_t left, int64_t right)
+{
+    std::sort(arg + left, arg + right, [arr](int64_t a, int64_t b) -> bool {
+        if ((!std::isnan(arr[a])) && (!std::isnan(arr[b]))) {
+            return arr[a] < arr[b];
+        }
+        else if (std::isnan(arr[a])) {
+            return false;
+        }
+        else {
+            return true;
+        }
+    });
+}
+
+/*
+ * The bitonic networks pad partially filled registers with
+ * vtype::type_max(). Equal keys can swap lanes in the network, so a padded
+ * lane could trade places with an element whose key is type_max() and its
+ * index would be lost. Move the indices of all such elements to the end of
+ * arg (they are already in their sorted position) and return the number of
+ * indices that are left to sort.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE int64_t move_max_to_end_of_arg(const type_t *arr,
+                                                    int64_t *arg,
+                                                    int64_t arrsize)
+{
+    const type_t max = vtype::type_max();
+    return std::partition(arg,
+                          arg + arrsize,
+                          [arr, max](int64_t a) { return arr[a] != max; })
+            - arg;
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+argsort_8_64bit(const type_t *arr, int64_t *arg, int32_t N)
+{
+    using zmm_t = typename vtype::zmm_t;
+    typename vtype::opmask_t load_mask = (0x01 << N) - 0x01;
+    argzmm_t argzmm = argtype::mask_loadu(argtype::zmm_max(), load_mask, arg);
+    zmm_t arrzmm = vtype::template mask_i64gather<sizeof(type_t)>(
+            vtype::zmm_max(), load_mask, argzmm, arr);
+    arrzmm = sort_zmm_64bit<vtype>(arrzmm, argzmm);
+    argtype::mask_storeu(arg, load_mask, argzmm);
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+argsort_16_64bit(const type_t *arr, int64_t *arg, int32_t N)
+{
+    if (N <= 8) {
+        argsort_8_64bit<vtype>(arr, arg, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    typename vtype::opmask_t load_mask = (0x01 << (N - 8)) - 0x01;
+    argzmm_t argzmm1 = argtype::loadu(arg);
+    argzmm_t argzmm2
+            = argtype::mask_loadu(argtype::zmm_max(), load_mask, arg + 8);
+    zmm_t arrzmm1 = vtype::template i64gather<sizeof(type_t)>(argzmm1, arr);
+    zmm_t arrzmm2 = vtype::template mask_i64gather<sizeof(type_t)>(
+            vtype::zmm_max(), load_mask, argzmm2, arr);
+    arrzmm1 = sort_zmm_64bit<vtype>(arrzmm1, argzmm1);
+    arrzmm2 = sort_zmm_64bit<vtype>(arrzmm2, argzmm2);
+    bitonic_merge_two_zmm_64bit<vtype>(arrzmm1, arrzmm2, argzmm1, argzmm2);
+    argtype::storeu(arg, argzmm1);
+    argtype::mask_storeu(arg + 8, load_mask, argzmm2);
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+argsort_32_64bit(const type_t *arr, int64_t *arg, int32_t N)
+{
+    if (N <= 16) {
+        argsort_16_64bit<vtype>(arr, arg, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    zmm_t arrzmm[4];
+    argzmm_t argzmm[4];
+
+    for (int ii = 0; ii < 2; ++ii) {
+        argzmm[ii] = argtype::loadu(arg + 8 * ii);
+        arrzmm[ii] = vtype::template i64gather<sizeof(type_t)>(argzmm[ii], arr);
+        arrzmm[ii] = sort_zmm_64bit<vtype>(arrzmm[ii], argzmm[ii]);
+    }
+
+    uint64_t combined_mask = (0x1ull << (N - 16)) - 0x1ull;
+    opmask_t load_mask[2];
+    for (int ii = 0; ii < 2; ++ii) {
+        load_mask[ii] = (combined_mask >> (8 * ii)) & 0xFF;
+        argzmm[ii + 2] = argtype::mask_loadu(
+                argtype::zmm_max(), load_mask[ii], arg + 16 + 8 * ii);
+        arrzmm[ii + 2] = vtype::template mask_i64gather<sizeof(type_t)>(
+                vtype::zmm_max(), load_mask[ii], argzmm[ii + 2], arr);
+        arrzmm[ii + 2] = sort_zmm_64bit<vtype>(arrzmm[ii + 2], argzmm[ii + 2]);
+    }
+
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[0], arrzmm[1], argzmm[0], argzmm[1]);
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[2], arrzmm[3], argzmm[2], argzmm[3]);
+    bitonic_merge_four_zmm_64bit<vtype>(arrzmm, argzmm);
+
+    argtype::storeu(arg, argzmm[0]);
+    argtype::storeu(arg + 8, argzmm[1]);
+    argtype::mask_storeu(arg + 16, load_mask[0], argzmm[2]);
+    argtype::mask_storeu(arg + 24, load_mask[1], argzmm[3]);
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+argsort_64_64bit(const type_t *arr, int64_t *arg, int32_t N)
+{
+    if (N <= 32) {
+        argsort_32_64bit<vtype>(arr, arg, N);
+        return;
+    }
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    zmm_t arrzmm[8];
+    argzmm_t argzmm[8];
+
+    for (int ii = 0; ii < 4; ++ii) {
+        argzmm[ii] = argtype::loadu(arg + 8 * ii);
+        arrzmm[ii] = vtype::template i64gather<sizeof(type_t)>(argzmm[ii], arr);
+        arrzmm[ii] = sort_zmm_64bit<vtype>(arrzmm[ii], argzmm[ii]);
+    }
+
+    // N-32 >= 1
+    uint64_t combined_mask = (0x1ull << (N - 32)) - 0x1ull;
+    opmask_t load_mask[4];
+    for (int ii = 0; ii < 4; ++ii) {
+        load_mask[ii] = (combined_mask >> (8 * ii)) & 0xFF;
+        argzmm[ii + 4] = argtype::mask_loadu(
+                argtype::zmm_max(), load_mask[ii], arg + 32 + 8 * ii);
+        arrzmm[ii + 4] = vtype::template mask_i64gather<sizeof(type_t)>(
+                vtype::zmm_max(), load_mask[ii], argzmm[ii + 4], arr);
+        arrzmm[ii + 4] = sort_zmm_64bit<vtype>(arrzmm[ii + 4], argzmm[ii + 4]);
+    }
+
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[0], arrzmm[1], argzmm[0], argzmm[1]);
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[2], arrzmm[3], argzmm[2], argzmm[3]);
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[4], arrzmm[5], argzmm[4], argzmm[5]);
+    bitonic_merge_two_zmm_64bit<vtype>(
+            arrzmm[6], arrzmm[7], argzmm[6], argzmm[7]);
+    bitonic_merge_four_zmm_64bit<vtype>(arrzmm, argzmm);
+    bitonic_merge_four_zmm_64bit<vtype>(arrzmm + 4, argzmm + 4);
+    bitonic_merge_eight_zmm_64bit<vtype>(arrzmm, argzmm);
+
+    for (int ii = 0; ii < 4; ++ii) {
+        argtype::storeu(arg + 8 * ii, argzmm[ii]);
+    }
+    for (int ii = 0; ii < 4; ++ii) {
+        argtype::mask_storeu(arg + 32 + 8 * ii, load_mask[ii], argzmm[ii + 4]);
+    }
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_64bit(const type_t *arr,
+                                            const int64_t *arg,
+                                            const int64_t left,
+                                            const int64_t right)
+{
+    // median of 8
+    int64_t size = (right - left) / 8;
+    using zmm_t = typename vtype::zmm_t;
+    __m512i rand_index = _mm512_set_epi64(arg[left + size],
+                                          arg[left + 2 * size],
+                                          arg[left + 3 * size],
+                                          arg[left + 4 * size],
+                                          arg[left + 5 * size],
+                                          arg[left + 6 * size],
+                                          arg[left + 7 * size],
+                                          arg[left + 8 * size]);
+    zmm_t rand_vec = vtype::template i64gather<sizeof(type_t)>(rand_index, arr);
+    // pivot will never be a nan, since there are no nan's!
+    zmm_t sort = sort_zmm_64bit<vtype>(rand_vec);
+    return ((type_t *)&sort)[4];
+}
+
+/*
+ * Parition one ZMM register of keys based on the pivot and store only the
+ * corresponding indices. Returns the number of keys greater than or equal
+ * to the pivot.
+ */
+template <typename vtype, typename zmm_t>
+X86_SIMD_SORT_INLINE int32_t partition_vec(int64_t *arg,
+                                           int64_t left,
+                                           int64_t right,
+                                           const argzmm_t arg_vec,
+                                           const zmm_t curr_vec,
+                                           const zmm_t pivot_vec,
+                                           zmm_t *smallest_vec,
+                                           zmm_t *biggest_vec)
+{
+    /* which elements are larger than the pivot */
+    typename vtype::opmask_t gt_mask = vtype::ge(curr_vec, pivot_vec);
+    int32_t amount_gt_pivot = _mm_popcnt_u32((int32_t)gt_mask);
+    argtype::mask_compressstoreu(
+            arg + left, vtype::knot_opmask(gt_mask), arg_vec);
+    argtype::mask_compressstoreu(
+            arg + right - amount_gt_pivot, gt_mask, arg_vec);
+    *smallest_vec = vtype::min(curr_vec, *smallest_vec);
+    *biggest_vec = vtype::max(curr_vec, *biggest_vec);
+    return amount_gt_pivot;
+}
+
+/*
+ * Parition the index array based on the pivot and returns the index of the
+ * last element that is less than equal to the pivot. Keys are gathered
+ * from arr and are never written to.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE int64_t partition_avx512(const type_t *arr,
+                                              int64_t *arg,
+                                              int64_t left,
+                                              int64_t right,
+                                              type_t pivot,
+                                              type_t *smallest,
+                                              type_t *biggest)
+{
+    /* make array length divisible by vtype::numlanes , shortening the array */
+    for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
+        *smallest = std::min(*smallest, arr[arg[left]], comparison_func<vtype>);
+        *biggest = std::max(*biggest, arr[arg[left]], comparison_func<vtype>);
+        if (!comparison_func<vtype>(arr[arg[left]], pivot)) {
+            std::swap(arg[left], arg[--right]);
+        }
+        else {
+            ++left;
+        }
+    }
+
+    if (left == right)
+        return left; /* less than vtype::numlanes elements in the array */
+
+    using zmm_t = typename vtype::zmm_t;
+    zmm_t pivot_vec = vtype::set1(pivot);
+    zmm_t min_vec = vtype::set1(*smallest);
+    zmm_t max_vec = vtype::set1(*biggest);
+
+    if (right - left == vtype::numlanes) {
+        argzmm_t argvec = argtype::loadu(arg + left);
+        zmm_t vec = vtype::template i64gather<sizeof(type_t)>(argvec, arr);
+        int32_t amount_gt_pivot = partition_vec<vtype>(arg,
+                                                       left,
+                                                       left + vtype::numlanes,
+                                                       argvec,
+                                                       vec,
+                                                       pivot_vec,
+                                                       &min_vec,
+                                                       &max_vec);
+        *smallest = vtype::reducemin(min_vec);
+        *biggest = vtype::reducemax(max_vec);
+        return left + (vtype::numlanes - amount_gt_pivot);
+    }
+
+    // first and last vtype::numlanes values are partitioned at the end
+    argzmm_t argvec_left = argtype::loadu(arg + left);
+    zmm_t vec_left
+            = vtype::template i64gather<sizeof(type_t)>(argvec_left, arr);
+    argzmm_t argvec_right = argtype::loadu(arg + (right - vtype::numlanes));
+    zmm_t vec_right
+            = vtype::template i64gather<sizeof(type_t)>(argvec_right, arr);
+    // store points of the vectors
+    int64_t r_store = right - vtype::numlanes;
+    int64_t l_store = left;
+    // indices for loading the elements
+    left += vtype::numlanes;
+    right -= vtype::numlanes;
+    while (right - left != 0) {
+        argzmm_t arg_vec;
+        zmm_t curr_vec;
+        /*
+         * if fewer elements are stored on the right side of the array,
+         * then next elements are loaded from the right side,
+         * otherwise from the left side
+         */
+        if ((r_store + vtype::numlanes) - right < left - l_store) {
+            right -= vtype::numlanes;
+            arg_vec = argtype::loadu(arg + right);
+        }
+        else {
+            arg_vec = argtype::loadu(arg + left);
+            left += vtype::numlanes;
+        }
+        curr_vec = vtype::template i64gather<sizeof(type_t)>(arg_vec, arr);
+        // partition the current vector and save it on both sides of the array
+        int32_t amount_gt_pivot
+                = partition_vec<vtype>(arg,
+                                       l_store,
+                                       r_store + vtype::numlanes,
+                                       arg_vec,
+                                       curr_vec,
+                                       pivot_vec,
+                                       &min_vec,
+                                       &max_vec);
+        r_store -= amount_gt_pivot;
+        l_store += (vtype::numlanes - amount_gt_pivot);
+    }
+
+    /* partition and save vec_left and vec_right */
+    int32_t amount_gt_pivot = partition_vec<vtype>(arg,
+                                                   l_store,
+                                                   r_store + vtype::numlanes,
+                                                   argvec_left,
+                                                   vec_left,
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
+    l_store += (vtype::numlanes - amount_gt_pivot);
+    amount_gt_pivot = partition_vec<vtype>(arg,
+                                           l_store,
+                                           l_store + vtype::numlanes,
+                                           argvec_right,
+                                           vec_right,
+                                           pivot_vec,
+                                           &min_vec,
+                                           &max_vec);
+    l_store += (vtype::numlanes - amount_gt_pivot);
+    *smallest = vtype::reducemin(min_vec);
+    *biggest = vtype::reducemax(max_vec);
+    return l_store;
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void argsort_64bit_(const type_t *arr,
+                                         int64_t *arg,
+                                         int64_t left,
+                                         int64_t right,
+                                         int64_t max_iters)
+{
+    /*
+     * Resort to std::sort if quicksort isnt making any progress
+     */
+    if (max_iters <= 0) {
+        std_argsort(arr, arg, left, right + 1);
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 64
+     */
+    if (right + 1 - left <= 64) {
+        argsort_64_64bit<vtype>(arr, arg + left, (int32_t)(right + 1 - left));
+        return;
+    }
+    type_t pivot = get_pivot_64bit<vtype>(arr, arg, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, arg, left, right + 1, pivot, &smallest, &biggest);
+    if (pivot != smallest)
+        argsort_64bit_<vtype>(arr, arg, left, pivot_index - 1, max_iters - 1);
+    if (pivot != biggest)
+        argsort_64bit_<vtype>(arr, arg, pivot_index, right, max_iters - 1);
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+argsort_64bit(const type_t *arr, int64_t *arg, int64_t arrsize)
+{
+    int64_t count = move_max_to_end_of_arg<vtype>(arr, arg, arrsize);
+    if (count > 1) {
+        argsort_64bit_<vtype>(
+                arr, arg, 0, count - 1, 2 * (int64_t)log2(count));
+    }
+}
+
+template <>
+void avx512_argsort<int64_t>(const int64_t *arr, int64_t *arg, int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        argsort_64bit<zmm_vector<int64_t>>(arr, arg, arrsize);
+    }
+}
+
+template <>
+void avx512_argsort<uint64_t>(const uint64_t *arr,
+                              int64_t *arg,
+                              int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        argsort_64bit<zmm_vector<uint64_t>>(arr, arg, arrsize);
+    }
+}
+
+template <>
+void avx512_argsort<double>(const double *arr, int64_t *arg, int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        if (has_nan(arr, arrsize)) {
+            std_argsort_withnan(arr, arg, 0, arrsize);
+            return;
+        }
+        argsort_64bit<zmm_vector<double>>(arr, arg, arrsize);
+    }
+}
+
+template <>
+void avx512_argsort<int32_t>(const int32_t *arr, int64_t *arg, int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        argsort_64bit<ymm_vector<int32_t>>(arr, arg, arrsize);
+    }
+}
+
+template <>
+void avx512_argsort<uint32_t>(const uint32_t *arr,
+                              int64_t *arg,
+                              int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        argsort_64bit<ymm_vector<uint32_t>>(arr, arg, arrsize);
+    }
+}
+
+template <>
+void avx512_argsort<float>(const float *arr, int64_t *arg, int64_t arrsize)
+{
+    std::iota(arg, arg + arrsize, 0);
+    if (arrsize > 1) {
+        if (has_nan(arr, arrsize)) {
+            std_argsort_withnan(arr, arg, 0, arrsize);
+            return;
+        }
+        argsort_64bit<ymm_vector<float>>(arr, arg, arrsize);
+    }
+}
+#endif // AVX512_ARGSORT_64BIT
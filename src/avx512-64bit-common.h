@@ -63,6 +63,12 @@ struct zmm_vector<int64_t> {
     {
         return _mm512_i64gather_epi64(index, base, scale);
     }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_epi64(src, mask, index, base, scale);
+    }
     static zmm_t loadu(void const *mem)
     {
         return _mm512_loadu_si512(mem);
@@ -95,6 +101,10 @@ struct zmm_vector<int64_t> {
     {
         return _mm512_permutexvar_epi64(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi64(NETWORK_64BIT_2), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_epi64(v);
@@ -157,6 +167,12 @@ struct zmm_vector<uint64_t> {
     {
         return _mm512_i64gather_epi64(index, base, scale);
     }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_epi64(src, mask, index, base, scale);
+    }
     static opmask_t knot_opmask(opmask_t x)
     {
         return _knot_mask8(x);
@@ -201,6 +217,10 @@ struct zmm_vector<uint64_t> {
     {
         return _mm512_permutexvar_epi64(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi64(NETWORK_64BIT_2), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_epu64(v);
@@ -275,6 +295,12 @@ struct zmm_vector<double> {
     {
         return _mm512_i64gather_pd(index, base, scale);
     }
+    template <int scale>
+    static zmm_t
+    mask_i64gather(zmm_t src, opmask_t mask, __m512i index, void const *base)
+    {
+        return _mm512_mask_i64gather_pd(src, mask, index, base, scale);
+    }
     static zmm_t loadu(void const *mem)
     {
         return _mm512_loadu_pd(mem);
@@ -307,6 +333,10 @@ struct zmm_vector<double> {
     {
         return _mm512_permutexvar_pd(idx, zmm);
     }
+    static zmm_t reverse(zmm_t zmm)
+    {
+        return permutexvar(_mm512_set_epi64(NETWORK_64BIT_2), zmm);
+    }
     static type_t reducemax(zmm_t v)
     {
         return _mm512_reduce_max_pd(v);
@@ -329,6 +359,20 @@ struct zmm_vector<double> {
         return _mm512_storeu_pd(mem, x);
     }
 };
+X86_SIMD_SORT_INLINE bool has_nan(const double *arr, int64_t arrsize)
+{
+    __mmask8 loadmask = 0xFF;
+    while (arrsize > 0) {
+        if (arrsize < 8) { loadmask = (0x01 << arrsize) - 0x01; }
+        __m512d in_zmm = _mm512_maskz_loadu_pd(loadmask, arr);
+        __mmask8 nanmask = _mm512_cmp_pd_mask(in_zmm, in_zmm, _CMP_NEQ_UQ);
+        if (nanmask != 0x00) { return true; }
+        arr += 8;
+        arrsize -= 8;
+    }
+    return false;
+}
+
 X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf(double *arr, int64_t arrsize)
 {
     int64_t nan_count = 0;
@@ -379,12 +423,14 @@ X86_SIMD_SORT_INLINE zmm_t sort_zmm_64bit(zmm_t zmm)
     return zmm;
 }
 
+/*
+ * Gathers 8 evenly spaced elements of arr[left, right] and returns them
+ * sorted: the pivot is their median
+ */
 template <typename vtype, typename type_t>
-X86_SIMD_SORT_INLINE type_t get_pivot_64bit(type_t *arr,
-                                            const int64_t left,
-                                            const int64_t right)
+X86_SIMD_SORT_INLINE typename vtype::zmm_t
+get_pivot_sample_64bit(type_t *arr, const int64_t left, const int64_t right)
 {
-    // median of 8
     int64_t size = (right - left) / 8;
     using zmm_t = typename vtype::zmm_t;
     __m512i rand_index = _mm512_set_epi64(left + size,
@@ -396,9 +442,7 @@ X86_SIMD_SORT_INLINE type_t get_pivot_64bit(type_t *arr,
                                           left + 7 * size,
                                           left + 8 * size);
     zmm_t rand_vec = vtype::template i64gather<sizeof(type_t)>(rand_index, arr);
-    // pivot will never be a nan, since there are no nan's!
-    zmm_t sort = sort_zmm_64bit<vtype>(rand_vec);
-    return ((type_t *)&sort)[4];
+    return sort_zmm_64bit<vtype>(rand_vec);
 }
 
 #endif
\ No newline at end of file
@@ -378,15 +378,69 @@ X86_SIMD_SORT_INLINE void sort_128_64bit(type_t *arr, int32_t N)
     vtype::mask_storeu(arr + 120, load_mask8, zmm[15]);
 }
 
+/*
+ * Pivot of qsort_64bit_: median of X86_SIMD_SORT_PIVOT_SAMPLES elements
+ * for large arrays and of 8 otherwise. *repeats tells whether the pivot
+ * occurs more than once in the sample.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_64bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right,
+                                            bool *repeats)
+{
+    if (right + 1 - left >= X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD) {
+        auto sort_samples = [](type_t *samples, int32_t N) {
+            sort_128_64bit<vtype>(samples, N);
+        };
+        return get_pivot_large_(arr, left, right, sort_samples, repeats);
+    }
+    typename vtype::zmm_t sort
+            = get_pivot_sample_64bit<vtype>(arr, left, right);
+    type_t pivot = ((type_t *)&sort)[4];
+    *repeats = pivot_repeats(sort, pivot);
+    return pivot;
+}
+
+/*
+ * Same pivot, for the callers that always partition two ways
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_64bit(type_t *arr,
+                                            const int64_t left,
+                                            const int64_t right)
+{
+    bool repeats;
+    return get_pivot_64bit<vtype>(arr, left, right, &repeats);
+}
+
+/*
+ * Fallback of qsort_64bit_ once it runs out of iterations: merge_sort_ with
+ * the 64-bit bitonic networks
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+merge_sort_64bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto sort_block = [](type_t *block, int32_t N) {
+        sort_128_64bit<vtype>(block, N);
+    };
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_64bit<vtype>(zmm1, zmm2);
+    };
+    merge_sort_<vtype>(arr, left, right, sort_block, merge_two);
+}
+
 template <typename vtype, typename type_t>
 static void
 qsort_64bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
 {
     /*
-     * Resort to std::sort if quicksort isnt making any progress
+     * Resort to merge sort if quicksort isnt making any progress
      */
     if (max_iters <= 0) {
-        std::sort(arr + left, arr + right + 1);
+        merge_sort_64bit_<vtype>(arr, left, right);
         return;
     }
     /*
@@ -397,21 +451,121 @@ qsort_64bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
         return;
     }
 
-    type_t pivot = get_pivot_64bit<vtype>(arr, left, right);
+    bool repeats;
+    type_t pivot = get_pivot_64bit<vtype>(arr, left, right, &repeats);
+    /*
+     * Many copies of the pivot: split off the elements equal to it, which
+     * are in place, and only recurse on both sides
+     */
+    if (repeats) {
+        int64_t lt_end, gt_start;
+        fat_partition_avx512<vtype>(
+                arr, left, right + 1, pivot, &lt_end, &gt_start);
+        if (lt_end - left > 1)
+            qsort_64bit_<vtype>(arr, left, lt_end - 1, max_iters - 1);
+        if (right - gt_start > 0)
+            qsort_64bit_<vtype>(arr, gt_start, right, max_iters - 1);
+        return;
+    }
     type_t smallest = vtype::type_max();
     type_t biggest = vtype::type_min();
-    int64_t pivot_index = partition_avx512<vtype>(
-            arr, left, right + 1, pivot, &smallest, &biggest);
+    int64_t pivot_index
+            = partition_avx512_unrolled<vtype, X86_SIMD_SORT_UNROLL_64BIT>(
+                    arr, left, right + 1, pivot, &smallest, &biggest);
     if (pivot != smallest)
         qsort_64bit_<vtype>(arr, left, pivot_index - 1, max_iters - 1);
     if (pivot != biggest)
         qsort_64bit_<vtype>(arr, pivot_index, right, max_iters - 1);
 }
 
+/*
+ * Segments that fit in the bitonic networks go to them directly, without the
+ * max_iters setup and the call overhead of avx512_qsort.
+ */
+template <typename vtype, typename type_t>
+static void segmented_sort_64bit_(type_t *data,
+                                  const int64_t *offsets,
+                                  int64_t nsegments)
+{
+    for (int64_t ii = 0; ii < nsegments; ++ii) {
+        type_t *arr = data + offsets[ii];
+        int64_t arrsize = offsets[ii + 1] - offsets[ii];
+        if (arrsize <= 1) { continue; }
+        if (arrsize <= 128) {
+            sort_128_64bit<vtype>(arr, (int32_t)arrsize);
+        }
+        else {
+            qsort_64bit_<vtype>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+    }
+}
+
+template <typename vtype, typename type_t>
+static void qselect_64bit_(type_t *arr,
+                           int64_t pos,
+                           int64_t left,
+                           int64_t right,
+                           int64_t max_iters)
+{
+    /*
+     * Resort to std::nth_element if quickselect isnt making any progress,
+     * with a lambda as in qselect_avx2_
+     */
+    if (max_iters <= 0) {
+        std::nth_element(arr + left,
+                         arr + pos,
+                         arr + right + 1,
+                         [](const type_t &a, const type_t &b) {
+                             return comparison_func<vtype>(a, b);
+                         });
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_64bit<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_64bit<vtype>(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * Only recurse into the side of the partition that contains pos
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_64bit_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_64bit_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
+/*
+ * Sorts arr[left, right] without quicksort and returns true if it is presorted
+ * (sort_if_presorted_, merging runs with the 64-bit bitonic network) or holds
+ * few distinct values (sort_if_few_unique_)
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_structured_64bit_(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    auto merge_two = [](zmm_t &zmm1, zmm_t &zmm2) {
+        bitonic_merge_two_zmm_64bit<vtype>(zmm1, zmm2);
+    };
+    return sort_if_presorted_<vtype>(arr, left, right, merge_two)
+            || sort_if_few_unique_<vtype>(arr, left, right);
+}
+
 template <>
 void avx512_qsort<int64_t>(int64_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (arrsize > 1
+        && !sort_if_structured_64bit_<zmm_vector<int64_t>>(
+                arr, 0, arrsize - 1)) {
         qsort_64bit_<zmm_vector<int64_t>, int64_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
@@ -420,7 +574,9 @@ void avx512_qsort<int64_t>(int64_t *arr, int64_t arrsize)
 template <>
 void avx512_qsort<uint64_t>(uint64_t *arr, int64_t arrsize)
 {
-    if (arrsize > 1) {
+    if (arrsize > 1
+        && !sort_if_structured_64bit_<zmm_vector<uint64_t>>(
+                arr, 0, arrsize - 1)) {
         qsort_64bit_<zmm_vector<uint64_t>, uint64_t>(
                 arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
     }
@@ -431,9 +587,142 @@ void avx512_qsort<double>(double *arr, int64_t arrsize)
 {
     if (arrsize > 1) {
         int64_t nan_count = replace_nan_with_inf(arr, arrsize);
-        qsort_64bit_<zmm_vector<double>, double>(
-                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        if (!sort_if_structured_64bit_<zmm_vector<double>>(
+                arr, 0, arrsize - 1)) {
+            qsort_64bit_<zmm_vector<double>, double>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
         replace_inf_with_nan(arr, arrsize, nan_count);
     }
 }
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<int64_t>>>(const int64_t &a,
+                                                       const int64_t &b)
+{
+    return comparison_func<zmm_vector<int64_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<uint64_t>>>(const uint64_t &a,
+                                                        const uint64_t &b)
+{
+    return comparison_func<zmm_vector<uint64_t>>(b, a);
+}
+
+template <>
+bool comparison_func<desc_vector<zmm_vector<double>>>(const double &a,
+                                                      const double &b)
+{
+    return comparison_func<zmm_vector<double>>(b, a);
+}
+
+template <>
+void avx512_qsort_desc<int64_t>(int64_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_64bit_<desc_vector<zmm_vector<int64_t>>>(
+                arr, 0, arrsize - 1)) {
+        qsort_64bit_<desc_vector<zmm_vector<int64_t>>, int64_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qsort_desc<uint64_t>(uint64_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1
+        && !sort_if_structured_64bit_<desc_vector<zmm_vector<uint64_t>>>(
+                arr, 0, arrsize - 1)) {
+        qsort_64bit_<desc_vector<zmm_vector<uint64_t>>, uint64_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+/*
+ * Unlike avx512_qsort<double>, the NAN's are moved to the end of the array and
+ * are not modified.
+ */
+template <>
+void avx512_qsort_desc<double>(double *arr, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if (indx_last_elem > 0
+        && !sort_if_structured_64bit_<desc_vector<zmm_vector<double>>>(
+                arr, 0, indx_last_elem)) {
+        qsort_64bit_<desc_vector<zmm_vector<double>>, double>(
+                arr, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_qselect<int64_t>(int64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_64bit_<zmm_vector<int64_t>, int64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<uint64_t>(uint64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_64bit_<zmm_vector<uint64_t>, uint64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<double>(double *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_64bit_<zmm_vector<double>, double>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_segmented_sort<int64_t>(int64_t *data,
+                                    const int64_t *offsets,
+                                    int64_t nsegments)
+{
+    segmented_sort_64bit_<zmm_vector<int64_t>>(data, offsets, nsegments);
+}
+
+template <>
+void avx512_segmented_sort<uint64_t>(uint64_t *data,
+                                     const int64_t *offsets,
+                                     int64_t nsegments)
+{
+    segmented_sort_64bit_<zmm_vector<uint64_t>>(data, offsets, nsegments);
+}
+
+/*
+ * NAN's are rare: look for them in all the segments at once and only fall
+ * back to avx512_qsort<double> for every segment when there are any.
+ */
+template <>
+void avx512_segmented_sort<double>(double *data,
+                                   const int64_t *offsets,
+                                   int64_t nsegments)
+{
+    if (nsegments <= 0) { return; }
+    if (has_nan(data + offsets[0], offsets[nsegments] - offsets[0])) {
+        for (int64_t ii = 0; ii < nsegments; ++ii) {
+            avx512_qsort<double>(data + offsets[ii],
+                                 offsets[ii + 1] - offsets[ii]);
+        }
+    }
+    else {
+        segmented_sort_64bit_<zmm_vector<double>>(data, offsets, nsegments);
+    }
+}
 #endif // AVX512_QSORT_64BIT
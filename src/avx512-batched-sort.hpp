@@ -0,0 +1,263 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+
+#ifndef AVX512_BATCHED_SORT
+#define AVX512_BATCHED_SORT
+
+#include "avx512-16bit-qsort.hpp"
+#include "avx512-32bit-qsort.hpp"
+#include "avx512-64bit-qsort.hpp"
+#include <vector>
+
+/*
+ * Sorts batchsize arrays of arrsize elements each, stored transposed: element
+ * ii of array jj is arr[ii * batchsize + jj], so every row of the matrix holds
+ * one element of every array. Each SIMD lane sorts a different array: a ZMM
+ * register is loaded from each row and Batcher's odd-even merge sort runs
+ * across the registers with vtype::min/max, so one network sorts
+ * vtype::numlanes arrays at once. The network is unrolled at compile time for
+ * 2, 4, 8, 16 and 32 rows; other sizes up to 32 are padded with
+ * vtype::type_max() rows that are never stored. Larger arrays and float or
+ * double arrays with NAN's are sorted one by one with avx512_qsort.
+ */
+template <typename T>
+void avx512_batched_sort(T *arr, int32_t arrsize, int64_t batchsize);
+
+template <typename vtype,
+          int ii,
+          int jj,
+          typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE void coex_rows(zmm_t *zmm)
+{
+    zmm_t tmp = zmm[ii];
+    zmm[ii] = vtype::min(tmp, zmm[jj]);
+    zmm[jj] = vtype::max(tmp, zmm[jj]);
+}
+
+/*
+ * Compile-time recursion of Batcher's odd-even merge sort over the registers
+ * zmm[lo..hi]. The bool parameter ends the recursion.
+ */
+template <typename vtype, int ii, int end, int r, bool = (ii < end)>
+struct oddeven_coex_range {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *)
+    {
+    }
+};
+
+template <typename vtype, int ii, int end, int r>
+struct oddeven_coex_range<vtype, ii, end, r, true> {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *zmm)
+    {
+        coex_rows<vtype, ii, ii + r>(zmm);
+        oddeven_coex_range<vtype, ii + 2 * r, end, r>::apply(zmm);
+    }
+};
+
+template <typename vtype, int lo, int hi, int r, bool = (2 * r < hi - lo)>
+struct oddeven_merge {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *zmm)
+    {
+        coex_rows<vtype, lo, lo + r>(zmm);
+    }
+};
+
+template <typename vtype, int lo, int hi, int r>
+struct oddeven_merge<vtype, lo, hi, r, true> {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *zmm)
+    {
+        oddeven_merge<vtype, lo, hi, 2 * r>::apply(zmm);
+        oddeven_merge<vtype, lo + r, hi, 2 * r>::apply(zmm);
+        oddeven_coex_range<vtype, lo + r, hi - r, r>::apply(zmm);
+    }
+};
+
+template <typename vtype, int lo, int hi, bool = (lo < hi)>
+struct oddeven_merge_sort {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *)
+    {
+    }
+};
+
+template <typename vtype, int lo, int hi>
+struct oddeven_merge_sort<vtype, lo, hi, true> {
+    template <typename zmm_t>
+    static inline void apply(zmm_t *zmm)
+    {
+        oddeven_merge_sort<vtype, lo, lo + (hi - lo) / 2>::apply(zmm);
+        oddeven_merge_sort<vtype, lo + (hi - lo) / 2 + 1, hi>::apply(zmm);
+        oddeven_merge<vtype, lo, hi, 1>::apply(zmm);
+    }
+};
+
+/*
+ * Sorts the columns of an arrsize x batchsize matrix with the network for
+ * numrows >= arrsize registers
+ */
+template <typename vtype, int numrows, typename type_t>
+X86_SIMD_SORT_INLINE void
+batched_sort_(type_t *arr, int32_t arrsize, int64_t batchsize)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    zmm_t zmm[numrows];
+    for (int64_t col = 0; col < batchsize; col += vtype::numlanes) {
+        type_t *base = arr + col;
+        if (batchsize - col >= vtype::numlanes) {
+            for (int ii = 0; ii < numrows; ++ii) {
+                zmm[ii] = (ii < arrsize) ? vtype::loadu(base + ii * batchsize)
+                                         : vtype::zmm_max();
+            }
+            oddeven_merge_sort<vtype, 0, numrows - 1>::apply(zmm);
+            for (int ii = 0; ii < arrsize; ++ii) {
+                vtype::storeu(base + ii * batchsize, zmm[ii]);
+            }
+        }
+        else {
+            opmask_t mask = (opmask_t)((1ull << (batchsize - col)) - 1);
+            for (int ii = 0; ii < numrows; ++ii) {
+                zmm[ii] = (ii < arrsize)
+                        ? vtype::mask_loadu(
+                                vtype::zmm_max(), mask, base + ii * batchsize)
+                        : vtype::zmm_max();
+            }
+            oddeven_merge_sort<vtype, 0, numrows - 1>::apply(zmm);
+            for (int ii = 0; ii < arrsize; ++ii) {
+                vtype::mask_storeu(base + ii * batchsize, mask, zmm[ii]);
+            }
+        }
+    }
+}
+
+/*
+ * Copies every array into a contiguous buffer and sorts it with
+ * qsort(buffer, arrsize)
+ */
+template <typename type_t, typename qsort_t>
+X86_SIMD_SORT_INLINE void batched_sort_one_by_one(type_t *arr,
+                                                  int32_t arrsize,
+                                                  int64_t batchsize,
+                                                  qsort_t qsort)
+{
+    std::vector<type_t> buffer(arrsize);
+    for (int64_t col = 0; col < batchsize; ++col) {
+        for (int32_t ii = 0; ii < arrsize; ++ii) {
+            buffer[ii] = arr[ii * batchsize + col];
+        }
+        qsort(buffer.data(), arrsize);
+        for (int32_t ii = 0; ii < arrsize; ++ii) {
+            arr[ii * batchsize + col] = buffer[ii];
+        }
+    }
+}
+
+template <typename vtype, typename type_t, typename qsort_t>
+X86_SIMD_SORT_INLINE void
+batched_sort(type_t *arr, int32_t arrsize, int64_t batchsize, qsort_t qsort)
+{
+    if (arrsize <= 1 || batchsize <= 0) { return; }
+    if (arrsize <= 2) { batched_sort_<vtype, 2>(arr, arrsize, batchsize); }
+    else if (arrsize <= 4) {
+        batched_sort_<vtype, 4>(arr, arrsize, batchsize);
+    }
+    else if (arrsize <= 8) {
+        batched_sort_<vtype, 8>(arr, arrsize, batchsize);
+    }
+    else if (arrsize <= 16) {
+        batched_sort_<vtype, 16>(arr, arrsize, batchsize);
+    }
+    else if (arrsize <= 32) {
+        batched_sort_<vtype, 32>(arr, arrsize, batchsize);
+    }
+    else {
+        batched_sort_one_by_one(arr, arrsize, batchsize, qsort);
+    }
+}
+
+template <>
+void avx512_batched_sort<int16_t>(int16_t *arr,
+                                  int32_t arrsize,
+                                  int64_t batchsize)
+{
+    batched_sort<zmm_vector<int16_t>>(
+            arr, arrsize, batchsize, avx512_qsort<int16_t>);
+}
+
+template <>
+void avx512_batched_sort<uint16_t>(uint16_t *arr,
+                                   int32_t arrsize,
+                                   int64_t batchsize)
+{
+    batched_sort<zmm_vector<uint16_t>>(
+            arr, arrsize, batchsize, avx512_qsort<uint16_t>);
+}
+
+template <>
+void avx512_batched_sort<int32_t>(int32_t *arr,
+                                  int32_t arrsize,
+                                  int64_t batchsize)
+{
+    batched_sort<zmm_vector<int32_t>>(
+            arr, arrsize, batchsize, avx512_qsort<int32_t>);
+}
+
+template <>
+void avx512_batched_sort<uint32_t>(uint32_t *arr,
+                                   int32_t arrsize,
+                                   int64_t batchsize)
+{
+    batched_sort<zmm_vector<uint32_t>>(
+            arr, arrsize, batchsize, avx512_qsort<uint32_t>);
+}
+
+template <>
+void avx512_batched_sort<float>(float *arr, int32_t arrsize, int64_t batchsize)
+{
+    if (has_nan(arr, (int64_t)arrsize * batchsize)) {
+        batched_sort_one_by_one(arr, arrsize, batchsize, avx512_qsort<float>);
+    }
+    else {
+        batched_sort<zmm_vector<float>>(
+                arr, arrsize, batchsize, avx512_qsort<float>);
+    }
+}
+
+template <>
+void avx512_batched_sort<int64_t>(int64_t *arr,
+                                  int32_t arrsize,
+                                  int64_t batchsize)
+{
+    batched_sort<zmm_vector<int64_t>>(
+            arr, arrsize, batchsize, avx512_qsort<int64_t>);
+}
+
+template <>
+void avx512_batched_sort<uint64_t>(uint64_t *arr,
+                                   int32_t arrsize,
+                                   int64_t batchsize)
+{
+    batched_sort<zmm_vector<uint64_t>>(
+            arr, arrsize, batchsize, avx512_qsort<uint64_t>);
+}
+
+template <>
+void avx512_batched_sort<double>(double *arr,
+                                 int32_t arrsize,
+                                 int64_t batchsize)
+{
+    if (has_nan(arr, (int64_t)arrsize * batchsize)) {
+        batched_sort_one_by_one(arr, arrsize, batchsize, avx512_qsort<double>);
+    }
+    else {
+        batched_sort<zmm_vector<double>>(
+                arr, arrsize, batchsize, avx512_qsort<double>);
+    }
+}
+#endif // AVX512_BATCHED_SORT
@@ -34,23 +34,33 @@
  */
 
 #include "avx512-64bit-common.h"
+#include <vector>
 
-template <typename T>
-void avx512_qsort_kv(T *keys, uint64_t *indexes, int64_t arrsize);
+template <typename T1, typename T2 = uint64_t>
+void avx512_qsort_kv(T1 *keys, T2 *indexes, int64_t arrsize);
+
+template <typename T1, typename T2 = uint64_t>
+void avx512_qsort_kv_desc(T1 *keys, T2 *indexes, int64_t arrsize);
 
 using index_t = __m512i;
 
+/*
+ * The key-value routines are templated on index_type, the vtype used to move
+ * the values around. Values are never compared, so any value type with the
+ * same size can share an index_type by reinterpreting its bits.
+ */
 template <typename vtype,
+          typename index_type = zmm_vector<uint64_t>,
           typename mm_t,
-          typename index_type = zmm_vector<uint64_t>>
-static void COEX(mm_t &key1, mm_t &key2, index_t &index1, index_t &index2)
+          typename idx_mm_t>
+static void COEX(mm_t &key1, mm_t &key2, idx_mm_t &index1, idx_mm_t &index2)
 {
     mm_t key_t1 = vtype::min(key1, key2);
     mm_t key_t2 = vtype::max(key1, key2);
 
-    index_t index_t1
+    idx_mm_t index_t1
             = index_type::mask_mov(index2, vtype::eq(key_t1, key1), index1);
-    index_t index_t2
+    idx_mm_t index_t2
             = index_type::mask_mov(index1, vtype::eq(key_t1, key1), index2);
 
     key1 = key_t1;
@@ -59,13 +69,14 @@ static void COEX(mm_t &key1, mm_t &key2, index_t &index1, index_t &index2)
     index2 = index_t2;
 }
 template <typename vtype,
+          typename index_type = zmm_vector<uint64_t>,
           typename zmm_t = typename vtype::zmm_t,
           typename opmask_t = typename vtype::opmask_t,
-          typename index_type = zmm_vector<uint64_t>>
+          typename idx_mm_t = typename index_type::zmm_t>
 static inline zmm_t cmp_merge(zmm_t in1,
                               zmm_t in2,
-                              index_t &indexes1,
-                              index_t indexes2,
+                              idx_mm_t &indexes1,
+                              idx_mm_t indexes2,
                               opmask_t mask)
 {
     zmm_t tmp_keys = cmp_merge<vtype>(in1, in2, mask);
@@ -73,20 +84,235 @@ static inline zmm_t cmp_merge(zmm_t in1,
             indexes2, vtype::eq(tmp_keys, in1), indexes1);
     return tmp_keys; // 0 -> min, 1 -> max
 }
+/*
+ * merge_scalar for key-value pairs: merges ka/va[0, na) and kb/vb[0, nb) into
+ * kout/vout, which may alias kb/vb as long as they start na or more elements
+ * before them
+ */
+template <typename vtype, typename type_t, typename idx_t>
+X86_SIMD_SORT_INLINE void merge_scalar(const type_t *ka,
+                                       const idx_t *va,
+                                       int64_t na,
+                                       const type_t *kb,
+                                       const idx_t *vb,
+                                       int64_t nb,
+                                       type_t *kout,
+                                       idx_t *vout)
+{
+    int64_t ia = 0, ib = 0;
+    while (ia < na && ib < nb) {
+        bool take_b = comparison_func<vtype>(kb[ib], ka[ia]);
+        *kout++ = take_b ? kb[ib] : ka[ia];
+        *vout++ = take_b ? vb[ib] : va[ia];
+        ib += take_b;
+        ia += !take_b;
+    }
+    std::copy(ka + ia, ka + na, kout);
+    std::copy(va + ia, va + na, vout);
+    std::copy(kb + ib, kb + nb, kout + (na - ia));
+    std::copy(vb + ib, vb + nb, vout + (na - ia));
+}
+
+/*
+ * merge_runs_ for key-value pairs: merges keys/indexes[left, mid) and
+ * [mid, end) in place, holding the first range in kbuf/vbuf. merge_two is the
+ * key-value bitonic network that merges two registers of keys along with
+ * their registers of values.
+ */
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t,
+          typename merge_t>
+X86_SIMD_SORT_INLINE void merge_runs_(type_t *keys,
+                                      idx_t *indexes,
+                                      int64_t left,
+                                      int64_t mid,
+                                      int64_t end,
+                                      type_t *kbuf,
+                                      idx_t *vbuf,
+                                      merge_t merge_two)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    const int numlanes = vtype::numlanes;
+    int64_t na = mid - left, nb = end - mid;
+    std::copy(keys + left, keys + mid, kbuf);
+    std::copy(indexes + left, indexes + mid, vbuf);
+    type_t *ka = kbuf, *kb = keys + mid, *kout = keys + left;
+    idx_t *va = vbuf, *vb = indexes + mid, *vout = indexes + left;
+    if (na < numlanes || nb < numlanes) {
+        merge_scalar<vtype>(ka, va, na, kb, vb, nb, kout, vout);
+        return;
+    }
+    zmm_t key_lo = vtype::loadu(ka);
+    zmm_t key_hi = vtype::loadu(kb);
+    idx_mm_t idx_lo = index_type::loadu(va);
+    idx_mm_t idx_hi = index_type::loadu(vb);
+    int64_t ia = numlanes, ib = numlanes;
+    merge_two(key_lo, key_hi, idx_lo, idx_hi);
+    vtype::storeu(kout, key_lo);
+    index_type::storeu(vout, idx_lo);
+    kout += numlanes;
+    vout += numlanes;
+    while (ia + numlanes <= na && ib + numlanes <= nb) {
+        if (comparison_func<vtype>(kb[ib], ka[ia])) {
+            key_lo = vtype::loadu(kb + ib);
+            idx_lo = index_type::loadu(vb + ib);
+            ib += numlanes;
+        }
+        else {
+            key_lo = vtype::loadu(ka + ia);
+            idx_lo = index_type::loadu(va + ia);
+            ia += numlanes;
+        }
+        merge_two(key_lo, key_hi, idx_lo, idx_hi);
+        vtype::storeu(kout, key_lo);
+        index_type::storeu(vout, idx_lo);
+        kout += numlanes;
+        vout += numlanes;
+    }
+    /* hi and the shorter tail fit in tmp, the longer tail stays in place */
+    type_t khi[numlanes], ktmp[2 * numlanes];
+    idx_t vhi[numlanes], vtmp[2 * numlanes];
+    vtype::storeu(khi, key_hi);
+    index_type::storeu(vhi, idx_hi);
+    if (na - ia < numlanes) {
+        merge_scalar<vtype>(
+                khi, vhi, numlanes, ka + ia, va + ia, na - ia, ktmp, vtmp);
+        merge_scalar<vtype>(ktmp,
+                            vtmp,
+                            numlanes + na - ia,
+                            kb + ib,
+                            vb + ib,
+                            nb - ib,
+                            kout,
+                            vout);
+    }
+    else {
+        merge_scalar<vtype>(
+                khi, vhi, numlanes, kb + ib, vb + ib, nb - ib, ktmp, vtmp);
+        merge_scalar<vtype>(ktmp,
+                            vtmp,
+                            numlanes + nb - ib,
+                            ka + ia,
+                            va + ia,
+                            na - ia,
+                            kout,
+                            vout);
+    }
+}
+
+/*
+ * merge_sort_ for key-value pairs, the fallback of the key-value quicksorts
+ * once they run out of iterations. sort_block is the 128 element key-value
+ * bitonic network of the dtype.
+ */
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t,
+          typename sort_t,
+          typename merge_t>
+X86_SIMD_SORT_INLINE void merge_sort_(type_t *keys,
+                                      idx_t *indexes,
+                                      int64_t left,
+                                      int64_t right,
+                                      sort_t sort_block,
+                                      merge_t merge_two)
+{
+    const int64_t blocksize = 128;
+    const int64_t end = right + 1;
+    for (int64_t ii = left; ii < end; ii += blocksize) {
+        sort_block(keys + ii,
+                   indexes + ii,
+                   (int32_t)std::min(blocksize, end - ii));
+    }
+    if (end - left <= blocksize) { return; }
+    std::vector<type_t> kbuf(end - left);
+    std::vector<idx_t> vbuf(end - left);
+    for (int64_t width = blocksize; width < end - left; width *= 2) {
+        for (int64_t ii = left; ii + width < end; ii += 2 * width) {
+            merge_runs_<vtype, index_type>(keys,
+                                           indexes,
+                                           ii,
+                                           ii + width,
+                                           std::min(ii + 2 * width, end),
+                                           kbuf.data(),
+                                           vbuf.data(),
+                                           merge_two);
+        }
+    }
+}
+
+/*
+ * Moves all the key-value pairs whose key is a NAN to the end of the arrays
+ * and returns the index of the last key that is not a NAN.
+ */
+template <typename type_t, typename idx_t>
+X86_SIMD_SORT_INLINE int64_t move_nans_to_end_of_array(type_t *keys,
+                                                       idx_t *indexes,
+                                                       int64_t arrsize)
+{
+    int64_t jj = arrsize - 1;
+    int64_t ii = 0;
+    while (ii <= jj) {
+        if (is_a_nan(keys[ii])) {
+            std::swap(keys[ii], keys[jj]);
+            std::swap(indexes[ii], indexes[jj]);
+            jj -= 1;
+        }
+        else {
+            ii += 1;
+        }
+    }
+    return jj;
+}
+
+/*
+ * The bitonic networks pad partially filled registers with
+ * vtype::type_max(). Equal keys can swap lanes in the network, so a key that
+ * equals type_max() could trade places with the padding and lose its value.
+ * Moves all such key-value pairs to the end of the arrays (which is where
+ * they belong) and returns the index of the last key that is left to sort.
+ */
+template <typename vtype, typename type_t, typename idx_t>
+X86_SIMD_SORT_INLINE int64_t move_max_to_end_of_array(type_t *keys,
+                                                      idx_t *indexes,
+                                                      int64_t arrsize)
+{
+    const type_t max = vtype::type_max();
+    int64_t jj = arrsize - 1;
+    int64_t ii = 0;
+    while (ii <= jj) {
+        if (keys[ii] == max) {
+            std::swap(keys[ii], keys[jj]);
+            std::swap(indexes[ii], indexes[jj]);
+            jj -= 1;
+        }
+        else {
+            ii += 1;
+        }
+    }
+    return jj;
+}
+
 /*
  * Parition one ZMM register based on the pivot and returns the index of the
  * last element that is less than equal to the pivot.
  */
 template <typename vtype,
+          typename index_type = zmm_vector<uint64_t>,
           typename type_t,
           typename zmm_t,
-          typename index_type = zmm_vector<uint64_t>>
+          typename idx_t = typename index_type::type_t,
+          typename idx_mm_t = typename index_type::zmm_t>
 static inline int32_t partition_vec(type_t *keys,
-                                    uint64_t *indexes,
+                                    idx_t *indexes,
                                     int64_t left,
                                     int64_t right,
                                     const zmm_t keys_vec,
-                                    const index_t indexes_vec,
+                                    const idx_mm_t indexes_vec,
                                     const zmm_t pivot_vec,
                                     zmm_t *smallest_vec,
                                     zmm_t *biggest_vec)
@@ -111,10 +337,11 @@ static inline int32_t partition_vec(type_t *keys,
  * last element that is less than equal to the pivot.
  */
 template <typename vtype,
+          typename index_type = zmm_vector<uint64_t>,
           typename type_t,
-          typename index_type = zmm_vector<uint64_t>>
+          typename idx_t = typename index_type::type_t>
 static inline int64_t partition_avx512(type_t *keys,
-                                       uint64_t *indexes,
+                                       idx_t *indexes,
                                        int64_t left,
                                        int64_t right,
                                        type_t pivot,
@@ -123,9 +350,9 @@ static inline int64_t partition_avx512(type_t *keys,
 {
     /* make array length divisible by vtype::numlanes , shortening the array */
     for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
-        *smallest = std::min(*smallest, keys[left]);
-        *biggest = std::max(*biggest, keys[left]);
-        if (keys[left] > pivot) {
+        *smallest = std::min(*smallest, keys[left], comparison_func<vtype>);
+        *biggest = std::max(*biggest, keys[left], comparison_func<vtype>);
+        if (comparison_func<vtype>(pivot, keys[left])) {
             right--;
             std::swap(keys[left], keys[right]);
             std::swap(indexes[left], indexes[right]);
@@ -139,6 +366,7 @@ static inline int64_t partition_avx512(type_t *keys,
         return left; /* less than vtype::numlanes elements in the array */
 
     using zmm_t = typename vtype::zmm_t;
+    using idx_mm_t = typename index_type::zmm_t;
     zmm_t pivot_vec = vtype::set1(pivot);
     zmm_t min_vec = vtype::set1(*smallest);
     zmm_t max_vec = vtype::set1(*biggest);
@@ -147,16 +375,17 @@ static inline int64_t partition_avx512(type_t *keys,
         zmm_t keys_vec = vtype::loadu(keys + left);
         int32_t amount_gt_pivot;
 
-        index_t indexes_vec = index_type::loadu(indexes + left);
-        amount_gt_pivot = partition_vec<vtype>(keys,
-                                               indexes,
-                                               left,
-                                               left + vtype::numlanes,
-                                               keys_vec,
-                                               indexes_vec,
-                                               pivot_vec,
-                                               &min_vec,
-                                               &max_vec);
+        idx_mm_t indexes_vec = index_type::loadu(indexes + left);
+        amount_gt_pivot
+                = partition_vec<vtype, index_type>(keys,
+                                                   indexes,
+                                                   left,
+                                                   left + vtype::numlanes,
+                                                   keys_vec,
+                                                   indexes_vec,
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
 
         *smallest = vtype::reducemin(min_vec);
         *biggest = vtype::reducemax(max_vec);
@@ -166,8 +395,8 @@ static inline int64_t partition_avx512(type_t *keys,
     // first and last vtype::numlanes values are partitioned at the end
     zmm_t keys_vec_left = vtype::loadu(keys + left);
     zmm_t keys_vec_right = vtype::loadu(keys + (right - vtype::numlanes));
-    index_t indexes_vec_left;
-    index_t indexes_vec_right;
+    idx_mm_t indexes_vec_left;
+    idx_mm_t indexes_vec_right;
     indexes_vec_left = index_type::loadu(indexes + left);
     indexes_vec_right = index_type::loadu(indexes + (right - vtype::numlanes));
 
@@ -179,7 +408,7 @@ static inline int64_t partition_avx512(type_t *keys,
     right -= vtype::numlanes;
     while (right - left != 0) {
         zmm_t keys_vec;
-        index_t indexes_vec;
+        idx_mm_t indexes_vec;
         /*
          * if fewer elements are stored on the right side of the array,
          * then next elements are loaded from the right side,
@@ -198,43 +427,269 @@ static inline int64_t partition_avx512(type_t *keys,
         // partition the current vector and save it on both sides of the array
         int32_t amount_gt_pivot;
 
-        amount_gt_pivot = partition_vec<vtype>(keys,
+        amount_gt_pivot
+                = partition_vec<vtype, index_type>(keys,
+                                                   indexes,
+                                                   l_store,
+                                                   r_store + vtype::numlanes,
+                                                   keys_vec,
+                                                   indexes_vec,
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
+        r_store -= amount_gt_pivot;
+        l_store += (vtype::numlanes - amount_gt_pivot);
+    }
+
+    /* partition and save vec_left and vec_right */
+    int32_t amount_gt_pivot;
+    amount_gt_pivot
+            = partition_vec<vtype, index_type>(keys,
                                                indexes,
                                                l_store,
                                                r_store + vtype::numlanes,
-                                               keys_vec,
-                                               indexes_vec,
+                                               keys_vec_left,
+                                               indexes_vec_left,
                                                pivot_vec,
                                                &min_vec,
                                                &max_vec);
+    l_store += (vtype::numlanes - amount_gt_pivot);
+    amount_gt_pivot
+            = partition_vec<vtype, index_type>(keys,
+                                               indexes,
+                                               l_store,
+                                               l_store + vtype::numlanes,
+                                               keys_vec_right,
+                                               indexes_vec_right,
+                                               pivot_vec,
+                                               &min_vec,
+                                               &max_vec);
+    l_store += (vtype::numlanes - amount_gt_pivot);
+    *smallest = vtype::reducemin(min_vec);
+    *biggest = vtype::reducemax(max_vec);
+    return l_store;
+}
+
+/*
+ * Key-value counterpart of the unrolled partition_avx512_unrolled() of
+ * avx512-common-qsort.h: num_unroll registers of keys, and of their indexes,
+ * are loaded and partitioned at a time.
+ */
+template <typename vtype,
+          int num_unroll,
+          typename index_type = zmm_vector<uint64_t>,
+          typename type_t,
+          typename idx_t = typename index_type::type_t>
+static inline int64_t partition_avx512_unrolled(type_t *keys,
+                                                idx_t *indexes,
+                                                int64_t left,
+                                                int64_t right,
+                                                type_t pivot,
+                                                type_t *smallest,
+                                                type_t *biggest)
+{
+    const int64_t blocksize = num_unroll * vtype::numlanes;
+    if (right - left <= 2 * blocksize) {
+        return partition_avx512<vtype, index_type>(
+                keys, indexes, left, right, pivot, smallest, biggest);
+    }
+    /* make array length divisible by vtype::numlanes, shortening the array */
+    for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
+        *smallest = std::min(*smallest, keys[left], comparison_func<vtype>);
+        *biggest = std::max(*biggest, keys[left], comparison_func<vtype>);
+        if (comparison_func<vtype>(pivot, keys[left])) {
+            right--;
+            std::swap(keys[left], keys[right]);
+            std::swap(indexes[left], indexes[right]);
+        }
+        else {
+            ++left;
+        }
+    }
+
+    using zmm_t = typename vtype::zmm_t;
+    using idx_mm_t = typename index_type::zmm_t;
+    zmm_t pivot_vec = vtype::set1(pivot);
+    zmm_t min_vec = vtype::set1(*smallest);
+    zmm_t max_vec = vtype::set1(*biggest);
+
+    /*
+     * first and last blocksize values, and the registers that do not fill a
+     * block, are partitioned at the end
+     */
+    int32_t num_extra = ((right - left) / vtype::numlanes) % num_unroll;
+    zmm_t keys_vec_left[num_unroll], keys_vec_right[num_unroll];
+    zmm_t keys_vec_extra[num_unroll];
+    idx_mm_t indexes_vec_left[num_unroll], indexes_vec_right[num_unroll];
+    idx_mm_t indexes_vec_extra[num_unroll];
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        int64_t l_pos = left + ii * vtype::numlanes;
+        int64_t r_pos = right - blocksize + ii * vtype::numlanes;
+        keys_vec_left[ii] = vtype::loadu(keys + l_pos);
+        indexes_vec_left[ii] = index_type::loadu(indexes + l_pos);
+        keys_vec_right[ii] = vtype::loadu(keys + r_pos);
+        indexes_vec_right[ii] = index_type::loadu(indexes + r_pos);
+    }
+    for (int ii = 0; ii < num_extra; ++ii) {
+        int64_t pos = left + blocksize + ii * vtype::numlanes;
+        keys_vec_extra[ii] = vtype::loadu(keys + pos);
+        indexes_vec_extra[ii] = index_type::loadu(indexes + pos);
+    }
+    // store points of the vectors
+    int64_t r_store = right - vtype::numlanes;
+    int64_t l_store = left;
+    // indices for loading the elements
+    left += blocksize + num_extra * vtype::numlanes;
+    right -= blocksize;
+    while (right - left != 0) {
+        zmm_t keys_vec[num_unroll];
+        idx_mm_t indexes_vec[num_unroll];
+        int64_t pos;
+        /*
+         * if fewer elements are stored on the right side of the array,
+         * then next elements are loaded from the right side,
+         * otherwise from the left side
+         */
+        if ((r_store + vtype::numlanes) - right < left - l_store) {
+            right -= blocksize;
+            pos = right;
+        }
+        else {
+            pos = left;
+            left += blocksize;
+        }
+        X86_SIMD_SORT_UNROLL_LOOP
+        for (int ii = 0; ii < num_unroll; ++ii) {
+            keys_vec[ii] = vtype::loadu(keys + pos + ii * vtype::numlanes);
+            indexes_vec[ii]
+                    = index_type::loadu(indexes + pos + ii * vtype::numlanes);
+        }
+        // partition the current vectors and save them on both sides
+        X86_SIMD_SORT_UNROLL_LOOP
+        for (int ii = 0; ii < num_unroll; ++ii) {
+            int32_t amount_gt_pivot = partition_vec<vtype, index_type>(
+                    keys,
+                    indexes,
+                    l_store,
+                    r_store + vtype::numlanes,
+                    keys_vec[ii],
+                    indexes_vec[ii],
+                    pivot_vec,
+                    &min_vec,
+                    &max_vec);
+            l_store += (vtype::numlanes - amount_gt_pivot);
+            r_store -= amount_gt_pivot;
+        }
+    }
+
+    /* partition and save vec_left, vec_extra and vec_right */
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype, index_type>(keys,
+                                                   indexes,
+                                                   l_store,
+                                                   r_store + vtype::numlanes,
+                                                   keys_vec_left[ii],
+                                                   indexes_vec_left[ii],
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
         r_store -= amount_gt_pivot;
+    }
+    for (int ii = 0; ii < num_extra; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype, index_type>(keys,
+                                                   indexes,
+                                                   l_store,
+                                                   r_store + vtype::numlanes,
+                                                   keys_vec_extra[ii],
+                                                   indexes_vec_extra[ii],
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
         l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype, index_type>(keys,
+                                                   indexes,
+                                                   l_store,
+                                                   r_store + vtype::numlanes,
+                                                   keys_vec_right[ii],
+                                                   indexes_vec_right[ii],
+                                                   pivot_vec,
+                                                   &min_vec,
+                                                   &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
     }
-
-    /* partition and save vec_left and vec_right */
-    int32_t amount_gt_pivot;
-    amount_gt_pivot = partition_vec<vtype>(keys,
-                                           indexes,
-                                           l_store,
-                                           r_store + vtype::numlanes,
-                                           keys_vec_left,
-                                           indexes_vec_left,
-                                           pivot_vec,
-                                           &min_vec,
-                                           &max_vec);
-    l_store += (vtype::numlanes - amount_gt_pivot);
-    amount_gt_pivot = partition_vec<vtype>(keys,
-                                           indexes,
-                                           l_store,
-                                           l_store + vtype::numlanes,
-                                           keys_vec_right,
-                                           indexes_vec_right,
-                                           pivot_vec,
-                                           &min_vec,
-                                           &max_vec);
-    l_store += (vtype::numlanes - amount_gt_pivot);
     *smallest = vtype::reducemin(min_vec);
     *biggest = vtype::reducemax(max_vec);
     return l_store;
 }
+/*
+ * Key-value counterpart of sort_if_few_unique_(): once find_few_unique has
+ * counted the keys, every register of keys is compared with each distinct key
+ * and the matching values are compressstored at the next free position of
+ * that key's group, which keeps the values of equal keys in their original
+ * order. The values are read from a copy of indexes, and the keys are then
+ * rewritten one run per key.
+ */
+template <typename vtype,
+          typename index_type,
+          typename type_t,
+          typename idx_t>
+X86_SIMD_SORT_INLINE bool
+sort_kv_if_few_unique_(type_t *keys, idx_t *indexes, int64_t arrsize)
+{
+    using bvtype = bits_vector<type_t>;
+    using bits_t = typename bvtype::type_t;
+    using zmm_t = typename bvtype::zmm_t;
+    if (arrsize < X86_SIMD_SORT_FEW_UNIQUE_THRESHOLD) { return false; }
+    bits_t uniq[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int64_t counts[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int64_t pos[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int order[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    zmm_t uniq_zmm[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int numkeys = find_few_unique(keys, arrsize, uniq, counts);
+    if (numkeys < 0) { return false; }
+    order_keys<vtype>(uniq, numkeys, order);
+    int64_t start = 0;
+    for (int kk = 0; kk < numkeys; ++kk) {
+        pos[order[kk]] = start;
+        start += counts[order[kk]];
+        uniq_zmm[kk] = bvtype::set1(uniq[kk]);
+    }
+    std::vector<idx_t> values(indexes, indexes + arrsize);
+    int64_t ii = 0;
+    for (; ii + bvtype::numlanes <= arrsize; ii += bvtype::numlanes) {
+        zmm_t key_zmm = bvtype::loadu(keys + ii);
+        auto index_zmm = index_type::loadu(values.data() + ii);
+        for (int kk = 0; kk < numkeys; ++kk) {
+            typename bvtype::opmask_t mask = bvtype::eq(key_zmm, uniq_zmm[kk]);
+            index_type::mask_compressstoreu(
+                    indexes + pos[kk], mask, index_zmm);
+            pos[kk] += _mm_popcnt_u32((int32_t)mask);
+        }
+    }
+    for (; ii < arrsize; ++ii) {
+        bits_t key = to_bits<bits_t>(keys[ii]);
+        int kk = 0;
+        while (uniq[kk] != key) {
+            kk += 1;
+        }
+        indexes[pos[kk]++] = values[ii];
+    }
+    int64_t left = 0;
+    for (int kk = 0; kk < numkeys; ++kk) {
+        fill_key<bvtype>(keys + left, uniq[order[kk]], counts[order[kk]]);
+        left += counts[order[kk]];
+    }
+    return true;
+}
 #endif // AVX512_QSORT_COMMON_KV
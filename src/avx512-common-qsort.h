@@ -36,8 +36,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <immintrin.h>
 #include <limits>
+#include <type_traits>
+#include <vector>
 
 #define X86_SIMD_SORT_INFINITY std::numeric_limits<double>::infinity()
 #define X86_SIMD_SORT_INFINITYF std::numeric_limits<float>::infinity()
@@ -61,7 +64,25 @@
 #define YMM_MAX_HALF _mm256_set1_epi16(X86_SIMD_SORT_INFINITYH)
 #define ZMM_MAX_UINT16 _mm512_set1_epi16(X86_SIMD_SORT_MAX_UINT16)
 #define ZMM_MAX_INT16 _mm512_set1_epi16(X86_SIMD_SORT_MAX_INT16)
-#define SHUFFLE_MASK(a, b, c, d) (a << 6) | (b << 4) | (c << 2) | d
+#define SHUFFLE_MASK(a, b, c, d) ((a << 6) | (b << 4) | (c << 2) | d)
+#define X86_SIMD_SORT_MAX_PRESORTED_RUNS 8
+#define X86_SIMD_SORT_FEW_UNIQUE_KEYS 16
+#define X86_SIMD_SORT_FEW_UNIQUE_THRESHOLD 1024
+#define X86_SIMD_SORT_PIVOT_SAMPLES 128
+#define X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD 16384
+#define X86_SIMD_SORT_UNROLL_16BIT 8
+#define X86_SIMD_SORT_UNROLL_32BIT 8
+#define X86_SIMD_SORT_UNROLL_64BIT 8
+#define X86_SIMD_SORT_UNROLL_KV 4
+#define X86_SIMD_SORT_SORT_COPY_THRESHOLD 4096
+
+/*
+ * The multi-threaded routines need OpenMP 4.0, for tasks and proc_bind
+ */
+#if defined(_OPENMP) && _OPENMP >= 201307
+#include <omp.h>
+#define X86_SIMD_SORT_USE_OPENMP
+#endif
 
 #ifdef _MSC_VER
 #define X86_SIMD_SORT_INLINE static inline
@@ -81,18 +102,139 @@
 #define X86_SIMD_SORT_FINLINE static
 #endif
 
+/*
+ * Fully unrolls the loops over the registers of the unrolled partitions, so
+ * that their register arrays are kept in registers
+ */
+#if defined(__GNUC__)
+#define X86_SIMD_SORT_UNROLL_LOOP _Pragma("GCC unroll 8")
+#else
+#define X86_SIMD_SORT_UNROLL_LOOP
+#endif
+
 template <typename type>
 struct zmm_vector;
 
+template <typename type>
+struct ymm_vector;
+
 template <typename T>
 void avx512_qsort(T *arr, int64_t arrsize);
 
+template <typename T>
+void avx512_qsort_desc(T *arr, int64_t arrsize);
+
+template <typename T>
+void avx512_qselect(T *arr, int64_t k, int64_t arrsize);
+
+template <typename T>
+void avx512_argsort(const T *arr, int64_t *arg, int64_t arrsize);
+
+/*
+ * Sorts every segment data[offsets[ii], offsets[ii + 1]) for ii in
+ * [0, nsegments) independently. offsets has nsegments + 1 entries.
+ */
+template <typename T>
+void avx512_segmented_sort(T *data, const int64_t *offsets, int64_t nsegments);
+
+/*
+ * Sorts the k smallest elements of the array and places them at the
+ * beginning, in ascending order. Order of the remaining elements is
+ * unspecified. A k larger than arrsize sorts the whole array.
+ */
+template <typename T>
+inline void avx512_partial_qsort(T *arr, int64_t k, int64_t arrsize)
+{
+    k = std::min(k, arrsize);
+    if (k > 0) {
+        avx512_qselect<T>(arr, k - 1, arrsize);
+        avx512_qsort<T>(arr, k - 1);
+    }
+}
+
 template <typename vtype, typename T = typename vtype::type_t>
 bool comparison_func(const T &a, const T &b)
 {
     return a < b;
 }
 
+/*
+ * Sorts in descending order when used in place of vtype: min and max swap
+ * roles, so the bitonic networks and partition_vec put the larger elements
+ * first, and the registers are padded with vtype::type_min() instead of
+ * vtype::type_max(). Every dtype also provides a specialization of
+ * comparison_func that reverses the scalar comparison.
+ */
+template <typename vtype>
+struct desc_vector : public vtype {
+    using type_t = typename vtype::type_t;
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+
+    static type_t type_max()
+    {
+        return vtype::type_min();
+    }
+    static type_t type_min()
+    {
+        return vtype::type_max();
+    }
+    static zmm_t zmm_max()
+    {
+        return vtype::set1(vtype::type_min());
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return vtype::ge(y, x);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return vtype::min(x, y);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return vtype::max(x, y);
+    }
+    static type_t reducemax(zmm_t v)
+    {
+        return vtype::reducemin(v);
+    }
+    static type_t reducemin(zmm_t v)
+    {
+        return vtype::reducemax(v);
+    }
+};
+
+template <typename type_t>
+X86_SIMD_SORT_INLINE bool is_a_nan(type_t elem)
+{
+    return std::isnan(elem);
+}
+
+/*
+ * Moves all the NAN's to the end of the array and returns the index of the
+ * last element that is not a NAN.
+ */
+template <typename type_t>
+X86_SIMD_SORT_INLINE int64_t move_nans_to_end_of_array(type_t *arr,
+                                                       int64_t arrsize)
+{
+    int64_t jj = arrsize - 1;
+    int64_t ii = 0;
+    int64_t count = 0;
+    while (ii <= jj) {
+        if (is_a_nan(arr[ii])) {
+            std::swap(arr[ii], arr[jj]);
+            jj -= 1;
+            count++;
+        }
+        else {
+            ii += 1;
+        }
+    }
+    return arrsize - count - 1;
+}
+
 /*
  * COEX == Compare and Exchange two registers by swapping min and max values
  */
@@ -241,4 +383,819 @@ static inline int64_t partition_avx512(type_t *arr,
     *biggest = vtype::reducemax(max_vec);
     return l_store;
 }
+
+/*
+ * Same as partition_avx512, but loads num_unroll registers at a time and
+ * keeps num_unroll registers from each end aside, so that the compressstores
+ * of one register overlap with the compares of the next ones and the branch
+ * that picks the side to load from runs once per num_unroll registers. The
+ * registers that do not fill a block of num_unroll are kept aside too, which
+ * leaves the scalar prefix as short as in partition_avx512. Arrays of at most
+ * 2 * num_unroll registers go to partition_avx512.
+ */
+template <typename vtype, int num_unroll, typename type_t>
+static inline int64_t partition_avx512_unrolled(type_t *arr,
+                                                int64_t left,
+                                                int64_t right,
+                                                type_t pivot,
+                                                type_t *smallest,
+                                                type_t *biggest)
+{
+    const int64_t blocksize = num_unroll * vtype::numlanes;
+    if (right - left <= 2 * blocksize) {
+        return partition_avx512<vtype>(
+                arr, left, right, pivot, smallest, biggest);
+    }
+    /* make array length divisible by vtype::numlanes, shortening the array */
+    for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
+        *smallest = std::min(*smallest, arr[left], comparison_func<vtype>);
+        *biggest = std::max(*biggest, arr[left], comparison_func<vtype>);
+        if (!comparison_func<vtype>(arr[left], pivot)) {
+            std::swap(arr[left], arr[--right]);
+        }
+        else {
+            ++left;
+        }
+    }
+
+    using zmm_t = typename vtype::zmm_t;
+    zmm_t pivot_vec = vtype::set1(pivot);
+    zmm_t min_vec = vtype::set1(*smallest);
+    zmm_t max_vec = vtype::set1(*biggest);
+
+    /*
+     * first and last blocksize values, and the registers that do not fill a
+     * block, are partitioned at the end
+     */
+    int32_t num_extra = ((right - left) / vtype::numlanes) % num_unroll;
+    zmm_t vec_left[num_unroll], vec_right[num_unroll], vec_extra[num_unroll];
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        vec_left[ii] = vtype::loadu(arr + left + ii * vtype::numlanes);
+        vec_right[ii] = vtype::loadu(arr + right - blocksize
+                                     + ii * vtype::numlanes);
+    }
+    for (int ii = 0; ii < num_extra; ++ii) {
+        vec_extra[ii] = vtype::loadu(arr + left + blocksize
+                                     + ii * vtype::numlanes);
+    }
+    // store points of the vectors
+    int64_t r_store = right - vtype::numlanes;
+    int64_t l_store = left;
+    // indices for loading the elements
+    left += blocksize + num_extra * vtype::numlanes;
+    right -= blocksize;
+    while (right - left != 0) {
+        zmm_t curr_vec[num_unroll];
+        /*
+         * if fewer elements are stored on the right side of the array,
+         * then next elements are loaded from the right side,
+         * otherwise from the left side
+         */
+        if ((r_store + vtype::numlanes) - right < left - l_store) {
+            right -= blocksize;
+            X86_SIMD_SORT_UNROLL_LOOP
+            for (int ii = 0; ii < num_unroll; ++ii) {
+                curr_vec[ii] = vtype::loadu(arr + right + ii * vtype::numlanes);
+            }
+        }
+        else {
+            X86_SIMD_SORT_UNROLL_LOOP
+            for (int ii = 0; ii < num_unroll; ++ii) {
+                curr_vec[ii] = vtype::loadu(arr + left + ii * vtype::numlanes);
+            }
+            left += blocksize;
+        }
+        // partition the current vectors and save them on both sides
+        X86_SIMD_SORT_UNROLL_LOOP
+        for (int ii = 0; ii < num_unroll; ++ii) {
+            int32_t amount_gt_pivot
+                    = partition_vec<vtype>(arr,
+                                           l_store,
+                                           r_store + vtype::numlanes,
+                                           curr_vec[ii],
+                                           pivot_vec,
+                                           &min_vec,
+                                           &max_vec);
+            l_store += (vtype::numlanes - amount_gt_pivot);
+            r_store -= amount_gt_pivot;
+        }
+    }
+
+    /* partition and save vec_left, vec_extra and vec_right */
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype>(arr,
+                                       l_store,
+                                       r_store + vtype::numlanes,
+                                       vec_left[ii],
+                                       pivot_vec,
+                                       &min_vec,
+                                       &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    for (int ii = 0; ii < num_extra; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype>(arr,
+                                       l_store,
+                                       r_store + vtype::numlanes,
+                                       vec_extra[ii],
+                                       pivot_vec,
+                                       &min_vec,
+                                       &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    X86_SIMD_SORT_UNROLL_LOOP
+    for (int ii = 0; ii < num_unroll; ++ii) {
+        int32_t amount_gt_pivot
+                = partition_vec<vtype>(arr,
+                                       l_store,
+                                       r_store + vtype::numlanes,
+                                       vec_right[ii],
+                                       pivot_vec,
+                                       &min_vec,
+                                       &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    *smallest = vtype::reducemin(min_vec);
+    *biggest = vtype::reducemax(max_vec);
+    return l_store;
+}
+
+/*
+ * Partitions src[0, arrsize) into dst, which must not overlap it: the
+ * elements less than pivot are compressstored from the start of dst and the
+ * others from its end. Since the two arrays are distinct, no register has to
+ * be held back to make room for the stores. Returns the number of elements
+ * less than pivot.
+ */
+template <typename vtype, typename type_t>
+static inline int64_t partition_copy_avx512(const type_t *src,
+                                            type_t *dst,
+                                            int64_t arrsize,
+                                            type_t pivot)
+{
+    using zmm_t = typename vtype::zmm_t;
+    zmm_t pivot_vec = vtype::set1(pivot);
+    zmm_t min_vec = pivot_vec;
+    zmm_t max_vec = pivot_vec;
+    int64_t l_store = 0;
+    int64_t r_store = arrsize;
+    int64_t ii = 0;
+    for (; ii + vtype::numlanes <= arrsize; ii += vtype::numlanes) {
+        int32_t amount_gt_pivot = partition_vec<vtype>(dst,
+                                                       l_store,
+                                                       r_store,
+                                                       vtype::loadu(src + ii),
+                                                       pivot_vec,
+                                                       &min_vec,
+                                                       &max_vec);
+        l_store += (vtype::numlanes - amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    for (; ii < arrsize; ++ii) {
+        if (comparison_func<vtype>(src[ii], pivot)) {
+            dst[l_store++] = src[ii];
+        }
+        else {
+            dst[--r_store] = src[ii];
+        }
+    }
+    return l_store;
+}
+
+/*
+ * Sorts src[0, arrsize) into dst with the copy fused into the first partition:
+ * partition_copy_avx512 reads src and writes both sides of the partition to
+ * dst, which are then sorted in place with avx512_qsort. Small arrays, and
+ * arrays whose pivot sample holds a NAN (std::nth_element needs a strict weak
+ * order), are copied and sorted instead.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+sort_copy_(const type_t *src, type_t *dst, int64_t arrsize)
+{
+    const int64_t nsamples = X86_SIMD_SORT_PIVOT_SAMPLES;
+    bool fuse = arrsize >= X86_SIMD_SORT_SORT_COPY_THRESHOLD;
+    type_t samples[nsamples];
+    if (fuse) {
+        const int64_t stride = arrsize / nsamples;
+        for (int64_t ii = 0; ii < nsamples; ++ii) {
+            samples[ii] = src[ii * stride + stride / 2];
+            /* a NAN compares false with everything */
+            fuse = fuse && (samples[ii] == samples[ii]);
+        }
+    }
+    if (!fuse) {
+        std::copy(src, src + arrsize, dst);
+        avx512_qsort<type_t>(dst, arrsize);
+        return;
+    }
+    /* A lambda keeps the instantiation local, as in qselect_avx2_ */
+    std::nth_element(samples,
+                     samples + nsamples / 2,
+                     samples + nsamples,
+                     [](const type_t &a, const type_t &b) {
+                         return comparison_func<vtype>(a, b);
+                     });
+    int64_t pivot_index = partition_copy_avx512<vtype>(
+            src, dst, arrsize, samples[nsamples / 2]);
+    avx512_qsort<type_t>(dst, pivot_index);
+    avx512_qsort<type_t>(dst + pivot_index, arrsize - pivot_index);
+    /*
+     * The vectorized compares send NAN's to the left side, whose sort leaves
+     * them at its end: move them past the right side
+     */
+    int64_t nan_count = 0;
+    while (nan_count < pivot_index
+           && dst[pivot_index - 1 - nan_count]
+                   != dst[pivot_index - 1 - nan_count]) {
+        ++nan_count;
+    }
+    if (nan_count > 0) {
+        std::rotate(dst + pivot_index - nan_count,
+                    dst + pivot_index,
+                    dst + arrsize);
+    }
+}
+
+/*
+ * Sorts src[0, arrsize) in ascending order into dst, leaving src untouched.
+ * dst must hold arrsize elements and may not overlap src unless it is src.
+ * Same result as copying src to dst and calling avx512_qsort on dst, without
+ * the extra pass over the array.
+ */
+template <typename T>
+inline void avx512_sort_copy(const T *src, T *dst, int64_t arrsize)
+{
+    if (src == dst) { avx512_qsort<T>(dst, arrsize); }
+    else {
+        sort_copy_<zmm_vector<T>>(src, dst, arrsize);
+    }
+}
+/*
+ * Reverses arr[left, right] in place, swapping one register from each end at
+ * a time
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+reverse_array(type_t *arr, int64_t left, int64_t right)
+{
+    using zmm_t = typename vtype::zmm_t;
+    while (right - left + 1 >= 2 * vtype::numlanes) {
+        zmm_t lo = vtype::loadu(arr + left);
+        zmm_t hi = vtype::loadu(arr + right + 1 - vtype::numlanes);
+        vtype::storeu(arr + left, vtype::reverse(hi));
+        vtype::storeu(arr + right + 1 - vtype::numlanes, vtype::reverse(lo));
+        left += vtype::numlanes;
+        right -= vtype::numlanes;
+    }
+    std::reverse(arr + left, arr + right + 1);
+}
+
+/*
+ * Merges the sorted arrays a[0, na) and b[0, nb) into out. out may alias b as
+ * long as out + na <= b, since the writes then never overtake the reads.
+ */
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void merge_scalar(const type_t *a,
+                                       int64_t na,
+                                       const type_t *b,
+                                       int64_t nb,
+                                       type_t *out)
+{
+    int64_t ia = 0, ib = 0;
+    while (ia < na && ib < nb) {
+        type_t x = a[ia], y = b[ib];
+        bool take_b = comparison_func<vtype>(y, x);
+        *out++ = take_b ? y : x;
+        ib += take_b;
+        ia += !take_b;
+    }
+    std::copy(a + ia, a + na, out);
+    std::copy(b + ib, b + nb, out + (na - ia));
+}
+
+/*
+ * Merges the sorted ranges arr[left, mid) and arr[mid, end) in place, using
+ * buf to hold the first one. Every step loads the register whose first
+ * element is smaller and merges it with the register of the largest elements
+ * seen so far with the merge_two bitonic network: its lower half is final and
+ * is stored. What is left once either range runs out of full registers is
+ * merged with merge_scalar.
+ */
+template <typename vtype, typename type_t, typename merge_t>
+X86_SIMD_SORT_INLINE void merge_runs_(type_t *arr,
+                                      int64_t left,
+                                      int64_t mid,
+                                      int64_t end,
+                                      type_t *buf,
+                                      merge_t merge_two)
+{
+    using zmm_t = typename vtype::zmm_t;
+    const int numlanes = vtype::numlanes;
+    int64_t na = mid - left, nb = end - mid;
+    std::copy(arr + left, arr + mid, buf);
+    type_t *a = buf, *b = arr + mid, *out = arr + left;
+    if (na < numlanes || nb < numlanes) {
+        merge_scalar<vtype>(a, na, b, nb, out);
+        return;
+    }
+    zmm_t lo = vtype::loadu(a);
+    zmm_t hi = vtype::loadu(b);
+    int64_t ia = numlanes, ib = numlanes;
+    merge_two(lo, hi);
+    vtype::storeu(out, lo);
+    out += numlanes;
+    while (ia + numlanes <= na && ib + numlanes <= nb) {
+        if (comparison_func<vtype>(b[ib], a[ia])) {
+            lo = vtype::loadu(b + ib);
+            ib += numlanes;
+        }
+        else {
+            lo = vtype::loadu(a + ia);
+            ia += numlanes;
+        }
+        merge_two(lo, hi);
+        vtype::storeu(out, lo);
+        out += numlanes;
+    }
+    /* hi and the shorter tail fit in tmp, the longer tail stays in place */
+    type_t hi_arr[numlanes], tmp[2 * numlanes];
+    vtype::storeu(hi_arr, hi);
+    if (na - ia < numlanes) {
+        merge_scalar<vtype>(hi_arr, numlanes, a + ia, na - ia, tmp);
+        merge_scalar<vtype>(tmp, numlanes + na - ia, b + ib, nb - ib, out);
+    }
+    else {
+        merge_scalar<vtype>(hi_arr, numlanes, b + ib, nb - ib, tmp);
+        merge_scalar<vtype>(tmp, numlanes + nb - ib, a + ia, na - ia, out);
+    }
+}
+
+/*
+ * Scans arr[left, right] for order before it is quicksorted: every register is
+ * compared with the register loaded one element further, which flags the
+ * descents (arr[ii] > arr[ii + 1]) and ascents (arr[ii] < arr[ii + 1]) of
+ * vtype::numlanes neighbours at once. A range made of at most
+ * X86_SIMD_SORT_MAX_PRESORTED_RUNS ascending runs is sorted by merging the
+ * runs pairwise with merge_runs_, a non-increasing range is reversed, and true
+ * is returned. Otherwise the range is left untouched and false is returned; on
+ * unordered data both conditions fail within the first register or two, so
+ * the scan costs a few loads.
+ */
+template <typename vtype, typename type_t, typename merge_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_presorted_(type_t *arr, int64_t left, int64_t right, merge_t merge_two)
+{
+    using zmm_t = typename vtype::zmm_t;
+    const int maxruns = X86_SIMD_SORT_MAX_PRESORTED_RUNS;
+    int64_t runstart[maxruns + 1] = {left};
+    int numruns = 1;
+    bool manyruns = false, ascent = false;
+    int64_t ii = left;
+    for (; ii + vtype::numlanes <= right; ii += vtype::numlanes) {
+        zmm_t curr = vtype::loadu(arr + ii);
+        zmm_t next = vtype::loadu(arr + ii + 1);
+        uint64_t descents = vtype::knot_opmask(vtype::ge(next, curr));
+        ascent = ascent || vtype::knot_opmask(vtype::ge(curr, next));
+        for (; descents != 0 && !manyruns; descents &= descents - 1) {
+            if (numruns == maxruns) { manyruns = true; }
+            else {
+                runstart[numruns++] = ii + 1 + __builtin_ctzll(descents);
+            }
+        }
+        if (manyruns && ascent) { return false; }
+    }
+    for (; ii < right; ++ii) {
+        ascent = ascent || comparison_func<vtype>(arr[ii], arr[ii + 1]);
+        if (comparison_func<vtype>(arr[ii + 1], arr[ii])) {
+            if (numruns == maxruns) { manyruns = true; }
+            else {
+                runstart[numruns++] = ii + 1;
+            }
+        }
+    }
+    if (!manyruns) {
+        if (numruns == 1) { return true; }
+        runstart[numruns] = right + 1;
+        std::vector<type_t> buf(right + 1 - left);
+        for (int width = 1; width < numruns; width *= 2) {
+            for (int jj = 0; jj + width < numruns; jj += 2 * width) {
+                merge_runs_<vtype>(arr,
+                                   runstart[jj],
+                                   runstart[jj + width],
+                                   runstart[std::min(jj + 2 * width, numruns)],
+                                   buf.data(),
+                                   merge_two);
+            }
+        }
+        return true;
+    }
+    if (!ascent) {
+        reverse_array<vtype>(arr, left, right);
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Sorts arr[left, right] in O(n log n) whatever the data, for when quicksort
+ * runs out of iterations. Blocks of 128 elements are sorted with sort_block,
+ * the bitonic network of the dtype, and then merged pairwise with merge_runs_
+ * in passes of doubling width, through one buffer as large as the range.
+ */
+template <typename vtype, typename type_t, typename sort_t, typename merge_t>
+X86_SIMD_SORT_INLINE void merge_sort_(type_t *arr,
+                                      int64_t left,
+                                      int64_t right,
+                                      sort_t sort_block,
+                                      merge_t merge_two)
+{
+    const int64_t blocksize = 128;
+    const int64_t end = right + 1;
+    for (int64_t ii = left; ii < end; ii += blocksize) {
+        sort_block(arr + ii, (int32_t)std::min(blocksize, end - ii));
+    }
+    if (end - left <= blocksize) { return; }
+    std::vector<type_t> buf(end - left);
+    for (int64_t width = blocksize; width < end - left; width *= 2) {
+        for (int64_t ii = left; ii + width < end; ii += 2 * width) {
+            merge_runs_<vtype>(arr,
+                               ii,
+                               ii + width,
+                               std::min(ii + 2 * width, end),
+                               buf.data(),
+                               merge_two);
+        }
+    }
+}
+/*
+ * Unsigned integer as wide as type_t
+ */
+template <typename type_t>
+using bits_type_t = typename std::conditional<
+        sizeof(type_t) == sizeof(uint16_t),
+        uint16_t,
+        typename std::conditional<sizeof(type_t) == sizeof(uint32_t),
+                                  uint32_t,
+                                  uint64_t>::type>::type;
+
+/*
+ * Unsigned vtype as wide as type_t. It compares elements bit by bit, so that
+ * unlike vtype::eq it tells -0.0 and 0.0 apart. The routines that take it as
+ * bvtype default to the ZMM one; other backends pass their own.
+ */
+template <typename type_t>
+using bits_vector = zmm_vector<bits_type_t<type_t>>;
+
+template <typename bits_t, typename type_t>
+X86_SIMD_SORT_INLINE bits_t to_bits(type_t val)
+{
+    bits_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return bits;
+}
+
+/*
+ * Returns the index of val in keys[0, numkeys), appending it if there is room
+ * and returning -1 otherwise
+ */
+template <typename bits_t>
+X86_SIMD_SORT_INLINE int
+find_or_add_key(bits_t *keys, int64_t *counts, int &numkeys, bits_t val)
+{
+    for (int kk = 0; kk < numkeys; ++kk) {
+        if (keys[kk] == val) { return kk; }
+    }
+    if (numkeys == X86_SIMD_SORT_FEW_UNIQUE_KEYS) { return -1; }
+    keys[numkeys] = val;
+    counts[numkeys] = 0;
+    return numkeys++;
+}
+
+/*
+ * Finds the distinct values of arr[0, arrsize) and how often each of them
+ * occurs, as long as there are at most X86_SIMD_SORT_FEW_UNIQUE_KEYS of them.
+ * The values are stored as bit patterns in keys and counts, in no particular
+ * order, and their number is returned, or -1 as soon as one too many shows
+ * up. A sample of 64 elements goes first and rejects most arrays after a
+ * handful of scalar loads; the full pass then compares every register with
+ * all the values found so far and only looks at the lanes that match none of
+ * them one by one.
+ */
+template <typename type_t,
+          typename bvtype = bits_vector<type_t>,
+          typename bits_t = typename bvtype::type_t>
+X86_SIMD_SORT_INLINE int find_few_unique(const type_t *arr,
+                                         int64_t arrsize,
+                                         bits_t *keys,
+                                         int64_t *counts)
+{
+    using zmm_t = typename bvtype::zmm_t;
+    const uint64_t all_lanes = (1ull << bvtype::numlanes) - 1;
+    int numkeys = 0;
+    for (int64_t ii = 0; ii < 64; ++ii) {
+        bits_t val = to_bits<bits_t>(arr[ii * arrsize / 64]);
+        if (find_or_add_key(keys, counts, numkeys, val) < 0) { return -1; }
+    }
+    zmm_t keys_zmm[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    for (int kk = 0; kk < numkeys; ++kk) {
+        keys_zmm[kk] = bvtype::set1(keys[kk]);
+    }
+    int64_t ii = 0;
+    for (; ii + bvtype::numlanes <= arrsize; ii += bvtype::numlanes) {
+        zmm_t zmm = bvtype::loadu(arr + ii);
+        uint64_t matched = 0;
+        for (int kk = 0; kk < numkeys; ++kk) {
+            uint64_t mask = bvtype::eq(zmm, keys_zmm[kk]);
+            counts[kk] += _mm_popcnt_u64(mask);
+            matched |= mask;
+        }
+        for (uint64_t rest = ~matched & all_lanes; rest != 0;
+             rest &= rest - 1) {
+            int64_t jj = ii + __builtin_ctzll(rest);
+            int kk = find_or_add_key(
+                    keys, counts, numkeys, to_bits<bits_t>(arr[jj]));
+            if (kk < 0) { return -1; }
+            keys_zmm[kk] = bvtype::set1(keys[kk]);
+            counts[kk] += 1;
+        }
+    }
+    for (; ii < arrsize; ++ii) {
+        int kk = find_or_add_key(
+                keys, counts, numkeys, to_bits<bits_t>(arr[ii]));
+        if (kk < 0) { return -1; }
+        counts[kk] += 1;
+    }
+    return numkeys;
+}
+
+/*
+ * Orders the numkeys bit patterns in keys as vtype sorts the values they
+ * represent, by filling order with their indices
+ */
+template <typename vtype, typename bits_t>
+X86_SIMD_SORT_INLINE void
+order_keys(const bits_t *keys, int numkeys, int *order)
+{
+    using type_t = typename vtype::type_t;
+    for (int kk = 0; kk < numkeys; ++kk) {
+        order[kk] = kk;
+    }
+    std::sort(order, order + numkeys, [keys](int a, int b) {
+        return comparison_func<vtype>(to_bits<type_t>(keys[a]),
+                                      to_bits<type_t>(keys[b]));
+    });
+}
+
+/*
+ * Writes count copies of the bit pattern val to arr
+ */
+template <typename bvtype, typename bits_t = typename bvtype::type_t>
+X86_SIMD_SORT_INLINE void fill_key(void *arr, bits_t val, int64_t count)
+{
+    using opmask_t = typename bvtype::opmask_t;
+    typename bvtype::zmm_t zmm = bvtype::set1(val);
+    bits_t *dst = (bits_t *)arr;
+    int64_t ii = 0;
+    for (; ii + bvtype::numlanes <= count; ii += bvtype::numlanes) {
+        bvtype::storeu(dst + ii, zmm);
+    }
+    if (ii < count) {
+        bvtype::mask_storeu(
+                dst + ii, (opmask_t)((1ull << (count - ii)) - 1), zmm);
+    }
+}
+
+/*
+ * Sorts arr[left, right] and returns true if it holds at most
+ * X86_SIMD_SORT_FEW_UNIQUE_KEYS distinct values (see find_few_unique): the
+ * array is then rewritten as one run of each value, in sorted order.
+ */
+template <typename vtype,
+          typename bvtype = bits_vector<typename vtype::type_t>,
+          typename type_t>
+X86_SIMD_SORT_INLINE bool
+sort_if_few_unique_(type_t *arr, int64_t left, int64_t right)
+{
+    using bits_t = typename bvtype::type_t;
+    int64_t arrsize = right + 1 - left;
+    if (arrsize < X86_SIMD_SORT_FEW_UNIQUE_THRESHOLD) { return false; }
+    bits_t keys[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int64_t counts[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int order[X86_SIMD_SORT_FEW_UNIQUE_KEYS];
+    int numkeys = find_few_unique<type_t, bvtype>(
+            arr + left, arrsize, keys, counts);
+    if (numkeys < 0) { return false; }
+    order_keys<vtype>(keys, numkeys, order);
+    for (int kk = 0; kk < numkeys; ++kk) {
+        fill_key<bvtype>(arr + left, keys[order[kk]], counts[order[kk]]);
+        left += counts[order[kk]];
+    }
+    return true;
+}
+/*
+ * Reinterprets the lanes of a register as the unsigned integers of bvtype
+ */
+template <typename bvtype, typename zmm_t>
+X86_SIMD_SORT_INLINE typename bvtype::zmm_t to_bits_zmm(zmm_t zmm)
+{
+    typename bvtype::zmm_t bits;
+    std::memcpy(&bits, &zmm, sizeof(bits));
+    return bits;
+}
+
+/*
+ * Returns true if the sorted pivot sample holds the pivot more than once,
+ * which means that a good share of the array is equal to it
+ */
+template <typename zmm_t, typename type_t>
+X86_SIMD_SORT_INLINE bool pivot_repeats(zmm_t sample, type_t pivot)
+{
+    using bvtype = bits_vector<type_t>;
+    using bits_t = typename bvtype::type_t;
+    uint64_t eq_mask = bvtype::eq(to_bits_zmm<bvtype>(sample),
+                                  bvtype::set1(to_bits<bits_t>(pivot)));
+    return _mm_popcnt_u64(eq_mask) > 1;
+}
+
+/*
+ * Median of X86_SIMD_SORT_PIVOT_SAMPLES elements of arr[left, right], for
+ * arrays of X86_SIMD_SORT_PIVOT_SAMPLE_THRESHOLD elements or more. A median
+ * of one register at a fixed stride is easily fooled there: a sawtooth whose
+ * period is close to the stride hands the same value to every lane. The array
+ * is cut into one stride per sample instead, and each stride contributes the
+ * element at a pseudo-random offset. The generator is seeded with the bounds,
+ * so the sort stays deterministic. sort_samples is the 128 element bitonic
+ * network of the dtype, and *repeats is set when the median occurs more than
+ * once in the sample, as in pivot_repeats.
+ */
+template <typename type_t, typename sort_t>
+X86_SIMD_SORT_INLINE type_t get_pivot_large_(type_t *arr,
+                                             const int64_t left,
+                                             const int64_t right,
+                                             sort_t sort_samples,
+                                             bool *repeats)
+{
+    using bits_t = bits_type_t<type_t>;
+    const int mid = X86_SIMD_SORT_PIVOT_SAMPLES / 2;
+    type_t samples[X86_SIMD_SORT_PIVOT_SAMPLES];
+    uint64_t stride
+            = (uint64_t)(right + 1 - left) / X86_SIMD_SORT_PIVOT_SAMPLES;
+    uint64_t state = (uint64_t)left * 0x9e3779b97f4a7c15ull + (uint64_t)right;
+    for (int ii = 0; ii < X86_SIMD_SORT_PIVOT_SAMPLES; ++ii) {
+        /* 64-bit LCG, whose upper half is scaled down to [0, stride) */
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        uint64_t offset = ((state >> 32) * stride) >> 32;
+        samples[ii] = arr[left + ii * stride + offset];
+    }
+    sort_samples(samples, X86_SIMD_SORT_PIVOT_SAMPLES);
+    bits_t pivot_bits = to_bits<bits_t>(samples[mid]);
+    *repeats = to_bits<bits_t>(samples[mid - 1]) == pivot_bits
+            || to_bits<bits_t>(samples[mid + 1]) == pivot_bits;
+    return samples[mid];
+}
+
+/*
+ * Three way version of partition_vec: stores the elements of curr_vec that
+ * are less than the pivot at arr + left and the ones larger than it right
+ * before arr + right, and drops the ones equal to it. Returns the number of
+ * elements less than the pivot and sets *amount_gt_pivot.
+ */
+template <typename vtype,
+          typename bvtype = bits_vector<typename vtype::type_t>,
+          typename type_t,
+          typename zmm_t>
+static inline int32_t fat_partition_vec(type_t *arr,
+                                        int64_t left,
+                                        int64_t right,
+                                        const zmm_t curr_vec,
+                                        const zmm_t pivot_vec,
+                                        int32_t *amount_gt_pivot)
+{
+    using opmask_t = typename vtype::opmask_t;
+    opmask_t lt_mask = vtype::knot_opmask(vtype::ge(curr_vec, pivot_vec));
+    opmask_t eq_mask = bvtype::eq(to_bits_zmm<bvtype>(curr_vec),
+                                  to_bits_zmm<bvtype>(pivot_vec));
+    opmask_t gt_mask = vtype::knot_opmask((opmask_t)(lt_mask | eq_mask));
+    int32_t amount_lt_pivot = _mm_popcnt_u32((int32_t)lt_mask);
+    *amount_gt_pivot = _mm_popcnt_u32((int32_t)gt_mask);
+    vtype::mask_compressstoreu(arr + left, lt_mask, curr_vec);
+    vtype::mask_compressstoreu(
+            arr + right - *amount_gt_pivot, gt_mask, curr_vec);
+    return amount_lt_pivot;
+}
+
+/*
+ * Partitions arr[left, right) into the elements less than the pivot, the
+ * elements equal to it and the elements larger than it, and sets *lt_end and
+ * *gt_start to the bounds of the middle block, which the caller leaves out of
+ * the recursion. The loop is the one of partition_avx512, except that the
+ * elements equal to the pivot are never stored: the gap they leave between
+ * both sides is filled with the pivot at the end. Equality is bitwise, so
+ * the other signed zero of a floating point pivot is kept with the larger
+ * elements rather than overwritten.
+ */
+template <typename vtype,
+          typename bvtype = bits_vector<typename vtype::type_t>,
+          typename type_t>
+static inline void fat_partition_avx512(type_t *arr,
+                                        int64_t left,
+                                        int64_t right,
+                                        type_t pivot,
+                                        int64_t *lt_end,
+                                        int64_t *gt_start)
+{
+    using bits_t = typename bvtype::type_t;
+    const bits_t pivot_bits = to_bits<bits_t>(pivot);
+    /* make array length divisible by vtype::numlanes , shortening the array */
+    const int64_t end = right;
+    for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
+        if (!comparison_func<vtype>(arr[left], pivot)) {
+            std::swap(arr[left], arr[--right]);
+        }
+        else {
+            ++left;
+        }
+    }
+    const int64_t tail = right;
+
+    using zmm_t = typename vtype::zmm_t;
+    zmm_t pivot_vec = vtype::set1(pivot);
+    int32_t amount_gt_pivot;
+    int64_t l_store = left;
+    int64_t r_store = right - vtype::numlanes;
+
+    if (right - left == vtype::numlanes) {
+        zmm_t vec = vtype::loadu(arr + left);
+        l_store += fat_partition_vec<vtype, bvtype>(
+                arr, left, right, vec, pivot_vec, &amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    else if (right - left > vtype::numlanes) {
+        // first and last vtype::numlanes values are partitioned at the end
+        zmm_t vec_left = vtype::loadu(arr + left);
+        zmm_t vec_right = vtype::loadu(arr + (right - vtype::numlanes));
+        // indices for loading the elements
+        left += vtype::numlanes;
+        right -= vtype::numlanes;
+        while (right - left != 0) {
+            zmm_t curr_vec;
+            /*
+             * load from the side with less free space: since the dropped
+             * elements only add free space, both sides always have room
+             * for a full register
+             */
+            if ((r_store + vtype::numlanes) - right < left - l_store) {
+                right -= vtype::numlanes;
+                curr_vec = vtype::loadu(arr + right);
+            }
+            else {
+                curr_vec = vtype::loadu(arr + left);
+                left += vtype::numlanes;
+            }
+            l_store += fat_partition_vec<vtype, bvtype>(
+                    arr,
+                    l_store,
+                    r_store + vtype::numlanes,
+                    curr_vec,
+                    pivot_vec,
+                    &amount_gt_pivot);
+            r_store -= amount_gt_pivot;
+        }
+        l_store += fat_partition_vec<vtype, bvtype>(arr,
+                                                    l_store,
+                                                    r_store + vtype::numlanes,
+                                                    vec_left,
+                                                    pivot_vec,
+                                                    &amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+        l_store += fat_partition_vec<vtype, bvtype>(arr,
+                                                    l_store,
+                                                    r_store + vtype::numlanes,
+                                                    vec_right,
+                                                    pivot_vec,
+                                                    &amount_gt_pivot);
+        r_store -= amount_gt_pivot;
+    }
+    else {
+        r_store = left - vtype::numlanes;
+    }
+    /* the elements equal to the pivot */
+    std::fill(arr + l_store, arr + r_store + vtype::numlanes, pivot);
+    *lt_end = l_store;
+    *gt_start = r_store + vtype::numlanes;
+    /* move the ones set aside by the scalar loop next to them */
+    for (int64_t jj = tail; jj < end; ++jj) {
+        if (to_bits<bits_t>(arr[jj]) == pivot_bits) {
+            arr[jj] = arr[*gt_start];
+            arr[(*gt_start)++] = pivot;
+        }
+    }
+}
 #endif // AVX512_QSORT_COMMON
@@ -0,0 +1,678 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+
+#ifndef AVX512_PARALLEL_QSORT
+#define AVX512_PARALLEL_QSORT
+
+#include "avx512-16bit-qsort.hpp"
+#include "avx512-32bit-qsort.hpp"
+#include "avx512-64bit-qsort.hpp"
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Multi-threaded version of avx512_qsort<T>. It runs the same quicksort, but
+ * above X86_SIMD_SORT_PARALLEL_THRESHOLD elements the two halves of every
+ * partition are sorted as OpenMP tasks, which the idle threads of the team
+ * steal from each other. The first few partitions are too big to wait for:
+ * they are split into one block per thread, every block is partitioned
+ * against the same pivot in parallel, and the elements that ended up on the
+ * wrong side of the combined split point are swapped back in parallel.
+ *
+ * avx512_sample_sort<T> is meant for arrays that span several NUMA nodes. It
+ * splits the array into one bucket per thread around splitters taken from a
+ * sorted sample, copies every element into its bucket with compressstore and
+ * sorts each bucket with avx512_qsort<T> on the thread that first touched the
+ * bucket's memory. Threads are spread over the OpenMP places, so with
+ * OMP_PLACES=sockets (or numa_domains) every bucket is allocated on, and
+ * sorted from, a single node.
+ *
+ * Like avx512_qsort<T>, both first look for presorted arrays and arrays with
+ * few distinct values, which they sort without quicksort, and
+ * avx512_qsort_parallel<T> counting-sorts large 16-bit arrays on one thread.
+ *
+ * Both need OpenMP 4.0 for tasks and proc_bind. When the code is built
+ * without OpenMP (or with an older version), they are just avx512_qsort<T>.
+ */
+
+/*
+ * Arrays smaller than this are sorted by a single thread
+ */
+#define X86_SIMD_SORT_PARALLEL_THRESHOLD 65536
+/*
+ * Number of sample elements per bucket used to pick the splitters
+ */
+#define X86_SIMD_SORT_OVERSAMPLING 64
+
+template <typename T>
+void avx512_qsort_parallel(T *arr, int64_t arrsize, int nthreads = 0);
+
+template <typename T>
+void avx512_sample_sort(T *arr, int64_t arrsize, int nthreads = 0);
+
+template <typename vtype, typename type_t>
+static bool sort_if_structured_(type_t *arr,
+                                int64_t arrsize,
+                                std::integral_constant<size_t, 2>)
+{
+    return sort_if_structured_16bit_<vtype>(arr, 0, arrsize - 1);
+}
+
+template <typename vtype, typename type_t>
+static bool sort_if_structured_(type_t *arr,
+                                int64_t arrsize,
+                                std::integral_constant<size_t, 4>)
+{
+    return sort_if_structured_32bit_<vtype>(arr, 0, arrsize - 1);
+}
+
+template <typename vtype, typename type_t>
+static bool sort_if_structured_(type_t *arr,
+                                int64_t arrsize,
+                                std::integral_constant<size_t, 8>)
+{
+    return sort_if_structured_64bit_<vtype>(arr, 0, arrsize - 1);
+}
+
+/*
+ * The presorted and few unique checks that avx512_qsort<T> makes before
+ * quicksort, for the sorts of this file: sorts arr and returns true if it
+ * needs no quicksort
+ */
+template <typename vtype, typename type_t>
+static bool sort_if_structured(type_t *arr, int64_t arrsize)
+{
+    return sort_if_structured_<vtype>(
+            arr, arrsize, std::integral_constant<size_t, sizeof(type_t)>());
+}
+
+#ifdef X86_SIMD_SORT_USE_OPENMP
+using interval_t = std::pair<int64_t, int64_t>;
+
+/*
+ * Swap count elements of the intervals in big_left, starting at the offset-th
+ * one, with the elements of the intervals in small_right at the same offset.
+ */
+template <typename type_t>
+static void swap_misplaced_intervals(type_t *arr,
+                                     const std::vector<interval_t> &big_left,
+                                     const std::vector<interval_t> &small_right,
+                                     int64_t offset,
+                                     int64_t count)
+{
+    size_t ii = 0, jj = 0;
+    int64_t pos_ii = big_left[0].first, pos_jj = small_right[0].first;
+    for (int64_t skip = offset; skip > 0;) {
+        int64_t len = big_left[ii].second - pos_ii;
+        if (skip < len) {
+            pos_ii += skip;
+            break;
+        }
+        skip -= len;
+        pos_ii = big_left[++ii].first;
+    }
+    for (int64_t skip = offset; skip > 0;) {
+        int64_t len = small_right[jj].second - pos_jj;
+        if (skip < len) {
+            pos_jj += skip;
+            break;
+        }
+        skip -= len;
+        pos_jj = small_right[++jj].first;
+    }
+    while (count > 0) {
+        int64_t len = std::min(count,
+                               std::min(big_left[ii].second - pos_ii,
+                                        small_right[jj].second - pos_jj));
+        std::swap_ranges(arr + pos_ii, arr + pos_ii + len, arr + pos_jj);
+        count -= len;
+        pos_ii += len;
+        pos_jj += len;
+        if (count > 0 && pos_ii == big_left[ii].second) {
+            pos_ii = big_left[++ii].first;
+        }
+        if (count > 0 && pos_jj == small_right[jj].second) {
+            pos_jj = small_right[++jj].first;
+        }
+    }
+}
+
+/*
+ * Same as partition_avx512, with the array split into nblocks blocks that are
+ * partitioned by separate tasks. Must be called from inside a parallel region.
+ */
+template <typename vtype, typename type_t>
+static int64_t partition_avx512_parallel(type_t *arr,
+                                         int64_t left,
+                                         int64_t right,
+                                         type_t pivot,
+                                         type_t *smallest,
+                                         type_t *biggest,
+                                         int nblocks)
+{
+    std::vector<int64_t> bounds(nblocks + 1);
+    std::vector<int64_t> splits(nblocks);
+    std::vector<type_t> block_smallest(nblocks, vtype::type_max());
+    std::vector<type_t> block_biggest(nblocks, vtype::type_min());
+    for (int ii = 0; ii <= nblocks; ++ii) {
+        bounds[ii] = left + (right - left) * ii / nblocks;
+    }
+    for (int ii = 0; ii < nblocks; ++ii) {
+#pragma omp task shared(bounds, splits, block_smallest, block_biggest)
+        splits[ii] = partition_avx512<vtype>(arr,
+                                             bounds[ii],
+                                             bounds[ii + 1],
+                                             pivot,
+                                             &block_smallest[ii],
+                                             &block_biggest[ii]);
+    }
+#pragma omp taskwait
+
+    int64_t mid = left;
+    for (int ii = 0; ii < nblocks; ++ii) {
+        mid += splits[ii] - bounds[ii];
+        *smallest = std::min(
+                *smallest, block_smallest[ii], comparison_func<vtype>);
+        *biggest = std::max(
+                *biggest, block_biggest[ii], comparison_func<vtype>);
+    }
+
+    /*
+     * Every block is now [< pivot | >= pivot]. Collect the elements >= pivot
+     * that lie left of mid and the elements < pivot that lie right of it:
+     * there are as many of each and swapping them completes the partition.
+     */
+    std::vector<interval_t> big_left, small_right;
+    int64_t misplaced = 0;
+    for (int ii = 0; ii < nblocks; ++ii) {
+        int64_t hi = std::min(bounds[ii + 1], mid);
+        if (splits[ii] < hi) {
+            big_left.emplace_back(splits[ii], hi);
+            misplaced += hi - splits[ii];
+        }
+        int64_t lo = std::max(bounds[ii], mid);
+        if (lo < splits[ii]) { small_right.emplace_back(lo, splits[ii]); }
+    }
+    if (misplaced > 0) {
+        for (int ii = 0; ii < nblocks; ++ii) {
+            int64_t start = misplaced * ii / nblocks;
+            int64_t count = misplaced * (ii + 1) / nblocks - start;
+            if (count == 0) { continue; }
+#pragma omp task shared(big_left, small_right)
+            swap_misplaced_intervals(arr, big_left, small_right, start, count);
+        }
+#pragma omp taskwait
+    }
+    return mid;
+}
+
+/*
+ * serial_sort(arr, left, right, max_iters) and get_pivot(arr, left, right)
+ * are the qsort_*bit_ and get_pivot_*bit routines of the dtype. nblocks is
+ * the number of blocks partition_avx512_parallel splits [left, right] into,
+ * 1 once the array is small enough to be partitioned by a single thread.
+ */
+template <typename vtype,
+          typename type_t,
+          typename serial_sort_t,
+          typename get_pivot_t>
+static void qsort_parallel_(type_t *arr,
+                            int64_t left,
+                            int64_t right,
+                            int64_t max_iters,
+                            int nblocks,
+                            serial_sort_t serial_sort,
+                            get_pivot_t get_pivot)
+{
+    int64_t size = right + 1 - left;
+    if (size <= X86_SIMD_SORT_PARALLEL_THRESHOLD || max_iters <= 0) {
+        serial_sort(arr, left, right, max_iters);
+        return;
+    }
+
+    type_t pivot = get_pivot(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index;
+    if (nblocks > 1) {
+        pivot_index = partition_avx512_parallel<vtype>(
+                arr, left, right + 1, pivot, &smallest, &biggest, nblocks);
+    }
+    else {
+        pivot_index = partition_avx512<vtype>(
+                arr, left, right + 1, pivot, &smallest, &biggest);
+    }
+    /* Both halves keep their share of the blocks */
+    int left_blocks
+            = std::max<int64_t>(1, nblocks * (pivot_index - left) / size);
+    int right_blocks
+            = std::max<int64_t>(1, nblocks * (right + 1 - pivot_index) / size);
+    if (pivot != smallest) {
+#pragma omp task
+        qsort_parallel_<vtype>(arr,
+                               left,
+                               pivot_index - 1,
+                               max_iters - 1,
+                               left_blocks,
+                               serial_sort,
+                               get_pivot);
+    }
+    if (pivot != biggest) {
+        qsort_parallel_<vtype>(arr,
+                               pivot_index,
+                               right,
+                               max_iters - 1,
+                               right_blocks,
+                               serial_sort,
+                               get_pivot);
+    }
+}
+#endif // X86_SIMD_SORT_USE_OPENMP
+
+template <typename vtype,
+          typename type_t,
+          typename serial_sort_t,
+          typename get_pivot_t>
+static void qsort_parallel(type_t *arr,
+                           int64_t arrsize,
+                           int nthreads,
+                           serial_sort_t serial_sort,
+                           get_pivot_t get_pivot)
+{
+    if (sort_if_structured<vtype>(arr, arrsize)) { return; }
+    int64_t max_iters = 2 * (int64_t)log2(arrsize);
+#ifdef X86_SIMD_SORT_USE_OPENMP
+    if (nthreads <= 0) { nthreads = omp_get_max_threads(); }
+    if (nthreads > 1 && arrsize > X86_SIMD_SORT_PARALLEL_THRESHOLD) {
+        /* Blocks of partition_avx512_parallel are never below the threshold */
+        int nblocks = (int)std::min<int64_t>(
+                nthreads, arrsize / X86_SIMD_SORT_PARALLEL_THRESHOLD);
+#pragma omp parallel num_threads(nthreads)
+#pragma omp single
+        qsort_parallel_<vtype>(arr,
+                               0,
+                               arrsize - 1,
+                               max_iters,
+                               nblocks,
+                               serial_sort,
+                               get_pivot);
+        return;
+    }
+#endif
+    serial_sort(arr, 0, arrsize - 1, max_iters);
+}
+
+#ifdef X86_SIMD_SORT_USE_OPENMP
+/*
+ * Bucket b of the sample sort holds the elements x with
+ * splitters[b - 1] <= x < splitters[b]. When pos is null, adds the size of
+ * every bucket of arr[0, arrsize) to counts[b]; otherwise copies the elements
+ * to buffer + pos[b] and advances pos[b].
+ */
+template <typename vtype, typename type_t>
+static void classify_buckets(const type_t *arr,
+                             int64_t arrsize,
+                             const std::vector<type_t> &splitters,
+                             int64_t *counts,
+                             int64_t *pos,
+                             type_t *buffer)
+{
+    using zmm_t = typename vtype::zmm_t;
+    using opmask_t = typename vtype::opmask_t;
+    const int nbuckets = (int)splitters.size() + 1;
+    int64_t ii = 0;
+    for (; ii + vtype::numlanes <= arrsize; ii += vtype::numlanes) {
+        zmm_t x = vtype::loadu(arr + ii);
+        /* ge_prev: lanes >= splitters[b - 1], a superset of ge_curr */
+        opmask_t ge_prev = (opmask_t)-1;
+        for (int b = 0; b < nbuckets && ge_prev != 0; ++b) {
+            opmask_t ge_curr = (b < nbuckets - 1)
+                    ? vtype::ge(x, vtype::set1(splitters[b]))
+                    : (opmask_t)0;
+            opmask_t in_bucket = ge_prev ^ ge_curr;
+            int32_t amount = _mm_popcnt_u32((int32_t)in_bucket);
+            if (pos == nullptr) { counts[b] += amount; }
+            else if (amount > 0) {
+                vtype::mask_compressstoreu(buffer + pos[b], in_bucket, x);
+                pos[b] += amount;
+            }
+            ge_prev = ge_curr;
+        }
+    }
+    for (; ii < arrsize; ++ii) {
+        int b = 0;
+        while (b < nbuckets - 1
+               && !comparison_func<vtype>(arr[ii], splitters[b])) {
+            ++b;
+        }
+        if (pos == nullptr) { counts[b] += 1; }
+        else {
+            buffer[pos[b]++] = arr[ii];
+        }
+    }
+}
+
+/*
+ * serial_sort(arr, arrsize) is avx512_qsort for the dtype. Needs
+ * O(arrsize) additional memory.
+ */
+template <typename vtype, typename type_t, typename serial_sort_t>
+static void sample_sort_(type_t *arr,
+                         int64_t arrsize,
+                         int nthreads,
+                         serial_sort_t serial_sort)
+{
+    const int nbuckets = nthreads;
+    int64_t nsamples = (int64_t)X86_SIMD_SORT_OVERSAMPLING * nbuckets;
+    std::vector<type_t> samples(nsamples);
+    for (int64_t ii = 0; ii < nsamples; ++ii) {
+        samples[ii] = arr[ii * arrsize / nsamples];
+    }
+    serial_sort(samples.data(), nsamples);
+    std::vector<type_t> splitters(nbuckets - 1);
+    for (int b = 0; b < nbuckets - 1; ++b) {
+        splitters[b] = samples[(b + 1) * nsamples / nbuckets];
+    }
+
+    /* counts and pos are indexed by [block * nbuckets + bucket] */
+    std::vector<int64_t> counts(nthreads * nbuckets, 0);
+    std::vector<int64_t> pos(nthreads * nbuckets);
+    std::vector<int64_t> bucket_start(nbuckets + 1);
+    /* Left uninitialized, so that the pages are not touched yet */
+    std::unique_ptr<type_t[]> buffer(new type_t[arrsize]);
+
+    /*
+     * Every loop runs one iteration per thread with a static schedule, so
+     * block t and bucket t are always handled by thread t.
+     */
+#pragma omp parallel num_threads(nthreads) proc_bind(spread)
+    {
+#pragma omp for schedule(static, 1)
+        for (int t = 0; t < nthreads; ++t) {
+            int64_t lo = arrsize * t / nthreads;
+            int64_t hi = arrsize * (t + 1) / nthreads;
+            classify_buckets<vtype>(arr + lo,
+                                    hi - lo,
+                                    splitters,
+                                    &counts[t * nbuckets],
+                                    nullptr,
+                                    buffer.get());
+        }
+#pragma omp single
+        {
+            bucket_start[0] = 0;
+            for (int b = 0; b < nbuckets; ++b) {
+                int64_t offset = bucket_start[b];
+                for (int t = 0; t < nthreads; ++t) {
+                    pos[t * nbuckets + b] = offset;
+                    offset += counts[t * nbuckets + b];
+                }
+                bucket_start[b + 1] = offset;
+            }
+        }
+        /* First touch places the pages of bucket t on the node of thread t */
+#pragma omp for schedule(static, 1)
+        for (int t = 0; t < nthreads; ++t) {
+            std::fill(buffer.get() + bucket_start[t],
+                      buffer.get() + bucket_start[t + 1],
+                      type_t(0));
+        }
+#pragma omp for schedule(static, 1)
+        for (int t = 0; t < nthreads; ++t) {
+            int64_t lo = arrsize * t / nthreads;
+            int64_t hi = arrsize * (t + 1) / nthreads;
+            classify_buckets<vtype>(arr + lo,
+                                    hi - lo,
+                                    splitters,
+                                    nullptr,
+                                    &pos[t * nbuckets],
+                                    buffer.get());
+        }
+#pragma omp for schedule(static, 1)
+        for (int t = 0; t < nthreads; ++t) {
+            int64_t size = bucket_start[t + 1] - bucket_start[t];
+            serial_sort(buffer.get() + bucket_start[t], size);
+            std::copy(buffer.get() + bucket_start[t],
+                      buffer.get() + bucket_start[t + 1],
+                      arr + bucket_start[t]);
+        }
+    }
+}
+#endif // X86_SIMD_SORT_USE_OPENMP
+
+template <typename vtype, typename type_t, typename serial_sort_t>
+static void sample_sort(type_t *arr,
+                        int64_t arrsize,
+                        int nthreads,
+                        serial_sort_t serial_sort)
+{
+#ifdef X86_SIMD_SORT_USE_OPENMP
+    if (nthreads <= 0) { nthreads = omp_get_max_threads(); }
+    /* Every bucket should be worth a thread */
+    if (nthreads > 1
+        && arrsize > (int64_t)nthreads * X86_SIMD_SORT_PARALLEL_THRESHOLD) {
+        if (!sort_if_structured<vtype>(arr, arrsize)) {
+            sample_sort_<vtype>(arr, arrsize, nthreads, serial_sort);
+        }
+        return;
+    }
+#endif
+    serial_sort(arr, arrsize);
+}
+
+template <typename vtype, typename type_t>
+static void qsort_parallel_16bit(type_t *arr, int64_t arrsize, int nthreads)
+{
+    qsort_parallel<vtype>(
+            arr,
+            arrsize,
+            nthreads,
+            [](type_t *arr, int64_t left, int64_t right, int64_t max_iters) {
+                qsort_16bit_<vtype>(arr, left, right, max_iters);
+            },
+            [](type_t *arr, int64_t left, int64_t right) {
+                return get_pivot_16bit<vtype>(arr, left, right);
+            });
+}
+
+template <typename vtype, typename type_t>
+static void qsort_parallel_32bit(type_t *arr, int64_t arrsize, int nthreads)
+{
+    qsort_parallel<vtype>(
+            arr,
+            arrsize,
+            nthreads,
+            [](type_t *arr, int64_t left, int64_t right, int64_t max_iters) {
+                qsort_32bit_<vtype>(arr, left, right, max_iters);
+            },
+            [](type_t *arr, int64_t left, int64_t right) {
+                return get_pivot_32bit<vtype>(arr, left, right);
+            });
+}
+
+template <typename vtype, typename type_t>
+static void qsort_parallel_64bit(type_t *arr, int64_t arrsize, int nthreads)
+{
+    qsort_parallel<vtype>(
+            arr,
+            arrsize,
+            nthreads,
+            [](type_t *arr, int64_t left, int64_t right, int64_t max_iters) {
+                qsort_64bit_<vtype>(arr, left, right, max_iters);
+            },
+            [](type_t *arr, int64_t left, int64_t right) {
+                return get_pivot_64bit<vtype>(arr, left, right);
+            });
+}
+
+template <>
+void avx512_qsort_parallel<int16_t>(int16_t *arr, int64_t arrsize, int nthreads)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_int16(arr, arr, arrsize, false);
+    }
+    else if (arrsize > 1) {
+        qsort_parallel_16bit<zmm_vector<int16_t>>(arr, arrsize, nthreads);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<uint16_t>(uint16_t *arr,
+                                     int64_t arrsize,
+                                     int nthreads)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_uint16(arr, arr, arrsize, false);
+    }
+    else if (arrsize > 1) {
+        qsort_parallel_16bit<zmm_vector<uint16_t>>(arr, arrsize, nthreads);
+    }
+}
+
+void avx512_qsort_fp16_parallel(uint16_t *arr,
+                                int64_t arrsize,
+                                int nthreads = 0)
+{
+    if (use_counting_sort_16bit(arrsize)) {
+        counting_sort_fp16(arr, arrsize, false);
+    }
+    else if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        qsort_parallel_16bit<zmm_vector<float16>>(arr, arrsize, nthreads);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<int32_t>(int32_t *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        qsort_parallel_32bit<zmm_vector<int32_t>>(arr, arrsize, nthreads);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<uint32_t>(uint32_t *arr,
+                                     int64_t arrsize,
+                                     int nthreads)
+{
+    if (arrsize > 1) {
+        qsort_parallel_32bit<zmm_vector<uint32_t>>(arr, arrsize, nthreads);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<float>(float *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        qsort_parallel_32bit<zmm_vector<float>>(arr, arrsize, nthreads);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<int64_t>(int64_t *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        qsort_parallel_64bit<zmm_vector<int64_t>>(arr, arrsize, nthreads);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<uint64_t>(uint64_t *arr,
+                                     int64_t arrsize,
+                                     int nthreads)
+{
+    if (arrsize > 1) {
+        qsort_parallel_64bit<zmm_vector<uint64_t>>(arr, arrsize, nthreads);
+    }
+}
+
+template <>
+void avx512_qsort_parallel<double>(double *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        qsort_parallel_64bit<zmm_vector<double>>(arr, arrsize, nthreads);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx512_sample_sort<int16_t>(int16_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<int16_t>>(
+            arr, arrsize, nthreads, avx512_qsort<int16_t>);
+}
+
+template <>
+void avx512_sample_sort<uint16_t>(uint16_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<uint16_t>>(
+            arr, arrsize, nthreads, avx512_qsort<uint16_t>);
+}
+
+void avx512_sample_sort_fp16(uint16_t *arr, int64_t arrsize, int nthreads = 0)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        sample_sort<zmm_vector<float16>>(
+                arr, arrsize, nthreads, avx512_qsort_fp16);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx512_sample_sort<int32_t>(int32_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<int32_t>>(
+            arr, arrsize, nthreads, avx512_qsort<int32_t>);
+}
+
+template <>
+void avx512_sample_sort<uint32_t>(uint32_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<uint32_t>>(
+            arr, arrsize, nthreads, avx512_qsort<uint32_t>);
+}
+
+template <>
+void avx512_sample_sort<float>(float *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        sample_sort<zmm_vector<float>>(
+                arr, arrsize, nthreads, avx512_qsort<float>);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+
+template <>
+void avx512_sample_sort<int64_t>(int64_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<int64_t>>(
+            arr, arrsize, nthreads, avx512_qsort<int64_t>);
+}
+
+template <>
+void avx512_sample_sort<uint64_t>(uint64_t *arr, int64_t arrsize, int nthreads)
+{
+    sample_sort<zmm_vector<uint64_t>>(
+            arr, arrsize, nthreads, avx512_qsort<uint64_t>);
+}
+
+template <>
+void avx512_sample_sort<double>(double *arr, int64_t arrsize, int nthreads)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf(arr, arrsize);
+        sample_sort<zmm_vector<double>>(
+                arr, arrsize, nthreads, avx512_qsort<double>);
+        replace_inf_with_nan(arr, arrsize, nan_count);
+    }
+}
+#endif // AVX512_PARALLEL_QSORT
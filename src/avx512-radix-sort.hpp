@@ -0,0 +1,576 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+
+#ifndef AVX512_RADIX_SORT
+#define AVX512_RADIX_SORT
+
+#include "avx512-32bit-keyvaluesort.hpp"
+#include "avx512-64bit-keyvaluesort.hpp"
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+/*
+ * Out-of-place LSD radix sort of 32-bit and 64-bit keys, one pass per byte of
+ * the key. The keys are first turned into unsigned integers that sort in the
+ * same order: the sign bit of signed integers is flipped, and negative floats
+ * have all their bits flipped while positive floats have their sign bit set.
+ * NAN's become the biggest key, so they end up at the end of the array (and
+ * come back as 0x7FFF...F). One pass builds the histograms of all the bytes,
+ * passes over a byte that is the same for every key are skipped, and every
+ * other pass scatters the keys into an arrsize buffer and back.
+ *
+ * Scattering straight into 256 buckets makes a cache miss, and a read for
+ * ownership, per element. Instead every bucket has a 64 byte staging line
+ * that is written to memory with a single aligned non-temporal store once it
+ * is full, so the destination is written a whole cache line at a time and
+ * never read.
+ *
+ * Unlike avx512_qsort<T>, the sort is stable and needs O(arrsize) additional
+ * memory. It makes sizeof(T) + 1 passes over the array whatever the input, so
+ * it only pays off for very large arrays.
+ */
+template <typename T>
+void avx512_radix_sort(T *arr, int64_t arrsize);
+
+/*
+ * Sorts keys and applies the same permutation to values, keeping the order of
+ * equal keys. Values can be any 4 or 8 byte type.
+ */
+template <typename T1, typename T2>
+void avx512_radix_sort_kv(T1 *keys, T2 *values, int64_t arrsize);
+
+/*
+ * Hybrid of a single MSD radix pass and avx512_qsort<T>. The first levels of
+ * quicksort on a big array are memory bound: every partition_avx512 reads and
+ * writes the whole array. Instead one pass builds the histogram of the top 16
+ * bits of the keys, adjacent bins are merged into buckets of about
+ * X86_SIMD_SORT_MSD_BUCKET_BYTES (so skewed keys, like floats, still give
+ * buckets of similar size), and one staged pass scatters the keys into them.
+ * Every bucket then stays in the L2 cache while avx512_qsort<T> sorts it and
+ * it is copied back. The buckets are independent: with OpenMP they are
+ * sorted by nthreads threads. Arrays below X86_SIMD_SORT_MSD_THRESHOLD
+ * elements, or whose keys all have the same top 16 bits, go to
+ * avx512_qsort<T> directly. It needs O(arrsize) additional memory.
+ */
+template <typename T>
+void avx512_msd_qsort(T *arr, int64_t arrsize, int nthreads = 1);
+
+/*
+ * Key-value version of avx512_msd_qsort, sorting every bucket with
+ * avx512_qsort_kv<T1, T2>
+ */
+template <typename T1, typename T2>
+void avx512_msd_qsort_kv(T1 *keys,
+                         T2 *values,
+                         int64_t arrsize,
+                         int nthreads = 1);
+
+#define X86_SIMD_SORT_MSD_THRESHOLD 1048576
+/*
+ * Smallest size in bytes of a bucket of avx512_msd_qsort. Arrays of up to 256
+ * such buckets are split into 256 buckets, bigger arrays into 2048.
+ */
+#define X86_SIMD_SORT_MSD_BUCKET_BYTES 262144
+
+template <typename T>
+struct radix_key_traits;
+
+template <>
+struct radix_key_traits<uint32_t> {
+    using key_t = uint32_t;
+    static __m512i encode(__m512i zmm)
+    {
+        return zmm;
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        return zmm;
+    }
+};
+
+template <>
+struct radix_key_traits<int32_t> {
+    using key_t = uint32_t;
+    static __m512i encode(__m512i zmm)
+    {
+        return _mm512_xor_si512(zmm, _mm512_set1_epi32(0x80000000));
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        return encode(zmm);
+    }
+};
+
+template <>
+struct radix_key_traits<float> {
+    using key_t = uint32_t;
+    static __m512i encode(__m512i zmm)
+    {
+        __mmask16 nanmask = _mm512_cmp_ps_mask(_mm512_castsi512_ps(zmm),
+                                               _mm512_castsi512_ps(zmm),
+                                               _CMP_UNORD_Q);
+        __m512i flip = _mm512_or_si512(_mm512_srai_epi32(zmm, 31),
+                                       _mm512_set1_epi32(0x80000000));
+        return _mm512_mask_mov_epi32(_mm512_xor_si512(zmm, flip),
+                                     nanmask,
+                                     _mm512_set1_epi32(0xFFFFFFFF));
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        __m512i notzmm = _mm512_xor_si512(zmm, _mm512_set1_epi32(0xFFFFFFFF));
+        __m512i flip = _mm512_or_si512(_mm512_srai_epi32(notzmm, 31),
+                                       _mm512_set1_epi32(0x80000000));
+        return _mm512_xor_si512(zmm, flip);
+    }
+};
+
+template <>
+struct radix_key_traits<uint64_t> {
+    using key_t = uint64_t;
+    static __m512i encode(__m512i zmm)
+    {
+        return zmm;
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        return zmm;
+    }
+};
+
+template <>
+struct radix_key_traits<int64_t> {
+    using key_t = uint64_t;
+    static __m512i encode(__m512i zmm)
+    {
+        return _mm512_xor_si512(zmm, _mm512_set1_epi64(0x8000000000000000));
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        return encode(zmm);
+    }
+};
+
+template <>
+struct radix_key_traits<double> {
+    using key_t = uint64_t;
+    static __m512i encode(__m512i zmm)
+    {
+        __mmask8 nanmask = _mm512_cmp_pd_mask(_mm512_castsi512_pd(zmm),
+                                              _mm512_castsi512_pd(zmm),
+                                              _CMP_UNORD_Q);
+        __m512i flip = _mm512_or_si512(_mm512_srai_epi64(zmm, 63),
+                                       _mm512_set1_epi64(0x8000000000000000));
+        return _mm512_mask_mov_epi64(_mm512_xor_si512(zmm, flip),
+                                     nanmask,
+                                     _mm512_set1_epi64(0xFFFFFFFFFFFFFFFF));
+    }
+    static __m512i decode(__m512i zmm)
+    {
+        __m512i notzmm = _mm512_xor_si512(
+                zmm, _mm512_set1_epi64(0xFFFFFFFFFFFFFFFF));
+        __m512i flip = _mm512_or_si512(_mm512_srai_epi64(notzmm, 63),
+                                       _mm512_set1_epi64(0x8000000000000000));
+        return _mm512_xor_si512(zmm, flip);
+    }
+};
+
+/*
+ * Applies transform to every key of arr in place, 64 bytes at a time
+ */
+template <typename key_t, typename transform_t>
+X86_SIMD_SORT_INLINE void
+transform_keys(key_t *arr, int64_t arrsize, transform_t transform)
+{
+    const int64_t numlanes = 64 / sizeof(key_t);
+    int64_t ii = 0;
+    for (; ii + numlanes <= arrsize; ii += numlanes) {
+        __m512i zmm = _mm512_loadu_si512(arr + ii);
+        _mm512_storeu_si512(arr + ii, transform(zmm));
+    }
+    if (ii < arrsize) {
+        __mmask16 mask = (__mmask16)((1u << ((arrsize - ii) * sizeof(key_t)
+                                             / sizeof(uint32_t)))
+                                     - 1);
+        __m512i zmm = _mm512_maskz_loadu_epi32(mask, arr + ii);
+        _mm512_mask_storeu_epi32(arr + ii, mask, transform(zmm));
+    }
+}
+
+template <typename T, typename key_t = typename radix_key_traits<T>::key_t>
+X86_SIMD_SORT_INLINE void radix_encode(T *arr, int64_t arrsize)
+{
+    if (std::is_unsigned<T>::value) { return; }
+    transform_keys((key_t *)arr, arrsize, [](__m512i zmm) {
+        return radix_key_traits<T>::encode(zmm);
+    });
+}
+
+template <typename T, typename key_t = typename radix_key_traits<T>::key_t>
+X86_SIMD_SORT_INLINE void radix_decode(T *arr, int64_t arrsize)
+{
+    if (std::is_unsigned<T>::value) { return; }
+    transform_keys((key_t *)arr, arrsize, [](__m512i zmm) {
+        return radix_key_traits<T>::decode(zmm);
+    });
+}
+
+/*
+ * Staging lines of the buckets of one scatter pass. A line holds the elements
+ * of a bucket that belong to the same 64 byte line of the destination keys;
+ * values are staged alongside at the same positions.
+ */
+template <typename key_t, typename val_t, int32_t numbuckets>
+struct radix_stage_t {
+    static const int64_t numlanes = 64 / sizeof(key_t);
+    key_t keys[numbuckets][numlanes];
+    val_t values[numbuckets][numlanes];
+    /* next position to write in the destination, always line aligned */
+    int64_t line[numbuckets];
+    /* number of elements in the staging line */
+    int64_t fill[numbuckets];
+    /* first position of the bucket in the destination */
+    int64_t start[numbuckets];
+};
+
+/*
+ * Writes the staging line of bucket d to the destination. Elements before the
+ * beginning of the bucket are never written, they belong to the previous one.
+ */
+template <bool with_values, typename stage_t, typename key_t, typename val_t>
+X86_SIMD_SORT_INLINE void
+radix_flush_line(stage_t *stage, int32_t d, key_t *dst_keys, val_t *dst_values)
+{
+    const int64_t numlanes = stage_t::numlanes;
+    int64_t line = stage->line[d];
+    if (line >= stage->start[d]) {
+        _mm512_stream_si512((__m512i *)(dst_keys + line),
+                            _mm512_loadu_si512(stage->keys[d]));
+        if (with_values) {
+            std::memcpy(dst_values + line,
+                        stage->values[d],
+                        numlanes * sizeof(val_t));
+        }
+    }
+    else {
+        for (int64_t jj = stage->start[d] - line; jj < numlanes; ++jj) {
+            dst_keys[line + jj] = stage->keys[d][jj];
+            if (with_values) { dst_values[line + jj] = stage->values[d][jj]; }
+        }
+    }
+    stage->line[d] = line + numlanes;
+    stage->fill[d] = 0;
+}
+
+/*
+ * One stable scatter pass of src into dst, digit(key) being the bucket of a
+ * key and counts the histogram of the buckets
+ */
+template <bool with_values,
+          int32_t numbuckets,
+          typename key_t,
+          typename val_t,
+          typename digit_t>
+X86_SIMD_SORT_INLINE void
+radix_scatter(const key_t *src_keys,
+              const val_t *src_values,
+              key_t *dst_keys,
+              val_t *dst_values,
+              int64_t arrsize,
+              const int64_t *counts,
+              digit_t digit,
+              radix_stage_t<key_t, val_t, numbuckets> *stage)
+{
+    const int64_t numlanes = radix_stage_t<key_t, val_t, numbuckets>::numlanes;
+    /* dst_keys is only key_t aligned: find where its 64 byte lines start */
+    const int64_t misalign = ((uintptr_t)dst_keys % 64) / sizeof(key_t);
+    int64_t start = 0;
+    for (int32_t d = 0; d < numbuckets; ++d) {
+        int64_t offset = (start + misalign) % numlanes;
+        stage->start[d] = start;
+        stage->line[d] = start - offset;
+        stage->fill[d] = offset;
+        start += counts[d];
+    }
+    for (int64_t ii = 0; ii < arrsize; ++ii) {
+        key_t key = src_keys[ii];
+        int32_t d = digit(key);
+        int64_t fill = stage->fill[d];
+        stage->keys[d][fill] = key;
+        if (with_values) { stage->values[d][fill] = src_values[ii]; }
+        stage->fill[d] = fill + 1;
+        if (fill + 1 == numlanes) {
+            radix_flush_line<with_values>(stage, d, dst_keys, dst_values);
+        }
+    }
+    _mm_sfence();
+    /* Whatever is left in the staging lines ends its bucket */
+    for (int32_t d = 0; d < numbuckets; ++d) {
+        int64_t line = stage->line[d];
+        int64_t first = std::max(stage->start[d] - line, (int64_t)0);
+        for (int64_t jj = first; jj < stage->fill[d]; ++jj) {
+            dst_keys[line + jj] = stage->keys[d][jj];
+            if (with_values) { dst_values[line + jj] = stage->values[d][jj]; }
+        }
+    }
+}
+
+template <bool with_values, typename key_t, typename val_t>
+X86_SIMD_SORT_INLINE void
+radix_sort_(key_t *keys, val_t *values, int64_t arrsize)
+{
+    const int32_t numpasses = sizeof(key_t);
+    std::unique_ptr<int64_t[]> counts(new int64_t[numpasses * 256]());
+    for (int64_t ii = 0; ii < arrsize; ++ii) {
+        key_t key = keys[ii];
+        for (int32_t pass = 0; pass < numpasses; ++pass) {
+            counts[pass * 256 + ((key >> (8 * pass)) & 0xFF)]++;
+        }
+    }
+    std::unique_ptr<key_t[]> buf_keys(new key_t[arrsize]);
+    std::unique_ptr<val_t[]> buf_values(with_values ? new val_t[arrsize]
+                                                    : nullptr);
+    std::unique_ptr<radix_stage_t<key_t, val_t, 256>> stage(
+            new radix_stage_t<key_t, val_t, 256>);
+    key_t *src_keys = keys, *dst_keys = buf_keys.get();
+    val_t *src_values = values, *dst_values = buf_values.get();
+    for (int32_t pass = 0; pass < numpasses; ++pass) {
+        int32_t shift = 8 * pass;
+        /* Every key has the same byte: nothing moves */
+        if (counts[pass * 256 + ((keys[0] >> shift) & 0xFF)] == arrsize) {
+            continue;
+        }
+        radix_scatter<with_values>(
+                src_keys,
+                src_values,
+                dst_keys,
+                dst_values,
+                arrsize,
+                counts.get() + pass * 256,
+                [shift](key_t key) { return (int32_t)((key >> shift) & 0xFF); },
+                stage.get());
+        std::swap(src_keys, dst_keys);
+        std::swap(src_values, dst_values);
+    }
+    if (src_keys != keys) {
+        std::memcpy(keys, src_keys, arrsize * sizeof(key_t));
+        if (with_values) {
+            std::memcpy(values, src_values, arrsize * sizeof(val_t));
+        }
+    }
+}
+
+template <typename T>
+X86_SIMD_SORT_INLINE void radix_sort(T *arr, int64_t arrsize)
+{
+    using key_t = typename radix_key_traits<T>::key_t;
+    if (arrsize <= 1) { return; }
+    radix_encode(arr, arrsize);
+    radix_sort_<false>((key_t *)arr, (key_t *)nullptr, arrsize);
+    radix_decode(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<int32_t>(int32_t *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<uint32_t>(uint32_t *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<float>(float *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<int64_t>(int64_t *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<uint64_t>(uint64_t *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <>
+void avx512_radix_sort<double>(double *arr, int64_t arrsize)
+{
+    radix_sort(arr, arrsize);
+}
+
+template <typename T1, typename T2>
+void avx512_radix_sort_kv(T1 *keys, T2 *values, int64_t arrsize)
+{
+    static_assert(sizeof(T2) == 4 || sizeof(T2) == 8,
+                  "values must be 4 or 8 bytes wide");
+    using key_t = typename radix_key_traits<T1>::key_t;
+    using val_t = typename std::conditional<sizeof(T2) == sizeof(uint32_t),
+                                            uint32_t,
+                                            uint64_t>::type;
+    if (arrsize <= 1) { return; }
+    radix_encode(keys, arrsize);
+    radix_sort_<true>((key_t *)keys, (val_t *)values, arrsize);
+    radix_decode(keys, arrsize);
+}
+
+/*
+ * Encodes the keys and builds the histogram of their top 16 bits
+ */
+template <typename T, typename key_t = typename radix_key_traits<T>::key_t>
+X86_SIMD_SORT_INLINE void
+msd_encode_histogram(T *arr, int64_t arrsize, int64_t *counts)
+{
+    const int32_t shift = 8 * sizeof(key_t) - 16;
+    const int64_t numlanes = 64 / sizeof(key_t);
+    key_t *keys = (key_t *)arr;
+    int64_t ii = 0;
+    for (; ii + numlanes <= arrsize; ii += numlanes) {
+        if (!std::is_unsigned<T>::value) {
+            __m512i zmm = _mm512_loadu_si512(keys + ii);
+            _mm512_storeu_si512(keys + ii, radix_key_traits<T>::encode(zmm));
+        }
+        for (int64_t jj = ii; jj < ii + numlanes; ++jj) {
+            counts[keys[jj] >> shift]++;
+        }
+    }
+    radix_encode(arr + ii, arrsize - ii);
+    for (; ii < arrsize; ++ii) {
+        counts[keys[ii] >> shift]++;
+    }
+}
+
+/*
+ * Splits the keys into at most numbuckets buckets of consecutive values of
+ * their top 16 bits, each with about bucketsize keys or more, then sorts every
+ * bucket with sort_bucket(keys, values, size) and copies it back. Returns
+ * false, with the keys untouched, if they all have the same top 16 bits.
+ */
+template <int32_t numbuckets,
+          bool with_values,
+          typename T,
+          typename val_t,
+          typename sort_t>
+X86_SIMD_SORT_INLINE bool msd_qsort_(T *keys,
+                                     val_t *values,
+                                     int64_t arrsize,
+                                     int64_t bucketsize,
+                                     int nthreads,
+                                     sort_t sort_bucket)
+{
+    using key_t = typename radix_key_traits<T>::key_t;
+    const int32_t shift = 8 * sizeof(key_t) - 16;
+    std::unique_ptr<int64_t[]> fine_counts(new int64_t[1 << 16]());
+    msd_encode_histogram(keys, arrsize, fine_counts.get());
+    if (fine_counts[((key_t *)keys)[0] >> shift] == arrsize) {
+        radix_decode(keys, arrsize);
+        return false;
+    }
+    /*
+     * Merge the 65536 bins into buckets of at least bucketsize keys. Once the
+     * last bucket is full the remaining bins are empty, and go to it too.
+     */
+    bucketsize = std::max(bucketsize, (arrsize - 1) / numbuckets + 1);
+    std::unique_ptr<uint16_t[]> bucket_of(new uint16_t[1 << 16]);
+    std::unique_ptr<int64_t[]> counts(new int64_t[numbuckets]());
+    int32_t d = 0;
+    for (int32_t bin = 0; bin < (1 << 16); ++bin) {
+        if (d < numbuckets - 1 && counts[d] >= bucketsize) { d++; }
+        bucket_of[bin] = d;
+        counts[d] += fine_counts[bin];
+    }
+    fine_counts.reset();
+    const uint16_t *digits = bucket_of.get();
+    auto digit = [digits, shift](key_t key) { return digits[key >> shift]; };
+
+    std::unique_ptr<key_t[]> buf_keys(new key_t[arrsize]);
+    std::unique_ptr<val_t[]> buf_values(with_values ? new val_t[arrsize]
+                                                    : nullptr);
+    std::unique_ptr<radix_stage_t<key_t, val_t, numbuckets>> stage(
+            new radix_stage_t<key_t, val_t, numbuckets>);
+    radix_scatter<with_values>((key_t *)keys,
+                               values,
+                               buf_keys.get(),
+                               buf_values.get(),
+                               arrsize,
+                               counts.get(),
+                               digit,
+                               stage.get());
+    stage.reset();
+
+    std::unique_ptr<int64_t[]> starts(new int64_t[numbuckets]);
+    int64_t start = 0;
+    for (d = 0; d < numbuckets; ++d) {
+        starts[d] = start;
+        start += counts[d];
+    }
+#ifdef X86_SIMD_SORT_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads) \
+        if (nthreads > 1)
+#else
+    (void)nthreads;
+#endif
+    for (int32_t b = 0; b < numbuckets; ++b) {
+        int64_t first = starts[b], size = counts[b];
+        if (size == 0) { continue; }
+        T *bucket_keys = (T *)(buf_keys.get() + first);
+        val_t *bucket_values = buf_values.get() + (with_values ? first : 0);
+        radix_decode(bucket_keys, size);
+        sort_bucket(bucket_keys, bucket_values, size);
+        std::memcpy(keys + first, bucket_keys, size * sizeof(T));
+        if (with_values) {
+            std::memcpy(values + first, bucket_values, size * sizeof(val_t));
+        }
+    }
+    return true;
+}
+
+template <bool with_values, typename T, typename val_t, typename sort_t>
+X86_SIMD_SORT_INLINE void msd_qsort(T *keys,
+                                    val_t *values,
+                                    int64_t arrsize,
+                                    int nthreads,
+                                    sort_t sort_bucket)
+{
+    const int64_t bucketsize = X86_SIMD_SORT_MSD_BUCKET_BYTES / sizeof(T);
+    bool done = false;
+    if (arrsize < X86_SIMD_SORT_MSD_THRESHOLD) {}
+    else if (arrsize <= 256 * bucketsize) {
+        done = msd_qsort_<256, with_values>(
+                keys, values, arrsize, bucketsize, nthreads, sort_bucket);
+    }
+    else {
+        done = msd_qsort_<2048, with_values>(
+                keys, values, arrsize, bucketsize, nthreads, sort_bucket);
+    }
+    if (!done) { sort_bucket(keys, values, arrsize); }
+}
+
+template <typename T>
+void avx512_msd_qsort(T *arr, int64_t arrsize, int nthreads)
+{
+    using key_t = typename radix_key_traits<T>::key_t;
+    auto sort_bucket = [](T *keys, key_t *, int64_t size) {
+        avx512_qsort<T>(keys, size);
+    };
+    msd_qsort<false>(arr, (key_t *)nullptr, arrsize, nthreads, sort_bucket);
+}
+
+template <typename T1, typename T2>
+void avx512_msd_qsort_kv(T1 *keys, T2 *values, int64_t arrsize, int nthreads)
+{
+    msd_qsort<true>(
+            keys, values, arrsize, nthreads, [](T1 *k, T2 *v, int64_t size) {
+                avx512_qsort_kv<T1, T2>(k, v, size);
+            });
+}
+#endif // AVX512_RADIX_SORT
@@ -0,0 +1,371 @@
+/*******************************************************************
+ * Copyright (C) 2022 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ * ****************************************************************/
+#ifndef AVX512_YMM_QSORT
+#define AVX512_YMM_QSORT
+
+/*
+ * Quicksort of the 32-bit and 64-bit dtypes on 256-bit registers with
+ * AVX-512VL, for the processors that lower their frequency while 512-bit
+ * instructions run (Skylake-SP, Cascade Lake): a sort that never touches a
+ * ZMM register keeps the core, and whatever else runs on it, at its AVX2
+ * frequency. avx512_ymm_vector<T> is avx2_vector<T> with the AVX-512VL
+ * versions of the operations AVX2 has to emulate: opmask_t is a __mmask8
+ * produced by the compares, mask_compressstoreu is vpcompress and the masked
+ * loads, stores and moves use the opmask directly, as do min and max of the
+ * 64-bit integers. The bitonic networks, the partitioning and the recursion
+ * are the ones of the AVX2 sort. (ymm_vector of avx512-32bit-qsort.hpp is
+ * another thing: the 32-bit keys of the 64-bit argsort.)
+ *
+ * Builds with -mavx512f -mavx512vl and the flags of the AVX2 sort; GCC also
+ * needs -mprefer-vector-width=256 -mmove-max=256 -mstore-max=256 (implied by
+ * -march=skylake-avx512 and later) to not copy arrays of registers through
+ * ZMM.
+ */
+
+#include "avx2-32bit-qsort.hpp"
+#include "avx2-64bit-qsort.hpp"
+
+template <typename type>
+struct avx512_ymm_vector;
+
+template <typename T>
+void avx512_ymm_qsort(T *arr, int64_t arrsize);
+
+template <typename T>
+void avx512_ymm_qselect(T *arr, int64_t k, int64_t arrsize);
+
+template <>
+struct avx512_ymm_vector<int32_t> : public avx2_vector<int32_t> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpge_epi32_mask(x, y);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpeq_epi32_mask(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_epi32(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi32(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi32(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_epi32(mem, mask, x);
+    }
+};
+template <>
+struct avx512_ymm_vector<uint32_t> : public avx2_vector<uint32_t> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpge_epu32_mask(x, y);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpeq_epi32_mask(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_epi32(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi32(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi32(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_epi32(mem, mask, x);
+    }
+};
+template <>
+struct avx512_ymm_vector<float> : public avx2_vector<float> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xFF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_ps_mask(x, y, _CMP_GE_OQ);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_ps_mask(x, y, _CMP_EQ_OQ);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_ps(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_ps(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_ps(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_ps(mem, mask, x);
+    }
+};
+template <>
+struct avx512_ymm_vector<int64_t> : public avx2_vector<int64_t> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpge_epi64_mask(x, y);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpeq_epi64_mask(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_epi64(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi64(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi64(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_epi64(mem, mask, x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epi64(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epi64(x, y);
+    }
+};
+template <>
+struct avx512_ymm_vector<uint64_t> : public avx2_vector<uint64_t> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpge_epu64_mask(x, y);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmpeq_epi64_mask(x, y);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_epi64(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_epi64(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_epi64(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_epi64(mem, mask, x);
+    }
+    static zmm_t min(zmm_t x, zmm_t y)
+    {
+        return _mm256_min_epu64(x, y);
+    }
+    static zmm_t max(zmm_t x, zmm_t y)
+    {
+        return _mm256_max_epu64(x, y);
+    }
+};
+template <>
+struct avx512_ymm_vector<double> : public avx2_vector<double> {
+    using opmask_t = __mmask8;
+
+    static opmask_t knot_opmask(opmask_t x)
+    {
+        return x ^ 0xF;
+    }
+    static opmask_t ge(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_pd_mask(x, y, _CMP_GE_OQ);
+    }
+    static opmask_t eq(zmm_t x, zmm_t y)
+    {
+        return _mm256_cmp_pd_mask(x, y, _CMP_EQ_OQ);
+    }
+    static void mask_compressstoreu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_compressstoreu_pd(mem, mask, x);
+    }
+    static zmm_t mask_loadu(zmm_t x, opmask_t mask, void const *mem)
+    {
+        return _mm256_mask_loadu_pd(x, mask, mem);
+    }
+    static zmm_t mask_mov(zmm_t x, opmask_t mask, zmm_t y)
+    {
+        return _mm256_mask_mov_pd(x, mask, y);
+    }
+    static void mask_storeu(void *mem, opmask_t mask, zmm_t x)
+    {
+        _mm256_mask_storeu_pd(mem, mask, x);
+    }
+};
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void ymm_qsort_(type_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1 && !sort_if_structured_avx2_<vtype>(arr, 0, arrsize - 1)) {
+        qsort_avx2_<vtype, type_t>(
+                arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void ymm_qsort_fp_(type_t *arr, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        int64_t nan_count = replace_nan_with_inf_avx2<vtype>(arr, arrsize);
+        if (!sort_if_structured_avx2_<vtype>(arr, 0, arrsize - 1)) {
+            qsort_avx2_<vtype, type_t>(
+                    arr, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+        }
+        replace_inf_with_nan_avx2(arr, arrsize, nan_count);
+    }
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+ymm_qselect_(type_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_avx2_<vtype, type_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void
+ymm_qselect_fp_(type_t *arr, int64_t k, int64_t arrsize)
+{
+    int64_t indx_last_elem = arrsize - 1;
+    if (has_nan_avx2<vtype>(arr, arrsize)) {
+        indx_last_elem = move_nans_to_end_of_array(arr, arrsize);
+    }
+    if ((indx_last_elem > 0) && (indx_last_elem >= k)) {
+        qselect_avx2_<vtype, type_t>(
+                arr, k, 0, indx_last_elem, 2 * (int64_t)log2(indx_last_elem));
+    }
+}
+
+template <>
+void avx512_ymm_qsort<int32_t>(int32_t *arr, int64_t arrsize)
+{
+    ymm_qsort_<avx512_ymm_vector<int32_t>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qsort<uint32_t>(uint32_t *arr, int64_t arrsize)
+{
+    ymm_qsort_<avx512_ymm_vector<uint32_t>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qsort<float>(float *arr, int64_t arrsize)
+{
+    ymm_qsort_fp_<avx512_ymm_vector<float>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qsort<int64_t>(int64_t *arr, int64_t arrsize)
+{
+    ymm_qsort_<avx512_ymm_vector<int64_t>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qsort<uint64_t>(uint64_t *arr, int64_t arrsize)
+{
+    ymm_qsort_<avx512_ymm_vector<uint64_t>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qsort<double>(double *arr, int64_t arrsize)
+{
+    ymm_qsort_fp_<avx512_ymm_vector<double>>(arr, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<int32_t>(int32_t *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_<avx512_ymm_vector<int32_t>>(arr, k, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<uint32_t>(uint32_t *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_<avx512_ymm_vector<uint32_t>>(arr, k, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<float>(float *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_fp_<avx512_ymm_vector<float>>(arr, k, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<int64_t>(int64_t *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_<avx512_ymm_vector<int64_t>>(arr, k, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<uint64_t>(uint64_t *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_<avx512_ymm_vector<uint64_t>>(arr, k, arrsize);
+}
+
+template <>
+void avx512_ymm_qselect<double>(double *arr, int64_t k, int64_t arrsize)
+{
+    ymm_qselect_fp_<avx512_ymm_vector<double>>(arr, k, arrsize);
+}
+#endif // AVX512_YMM_QSORT
@@ -3,15 +3,39 @@
  * * SPDX-License-Identifier: BSD-3-Clause
  * *******************************************/
 
+#include "avx2-32bit-qsort.hpp"
+#include "avx2-64bit-qsort.hpp"
 #include "avx512-16bit-qsort.hpp"
+#include "avx512-batched-sort.hpp"
+#include "avx512-32bit-keyvaluesort.hpp"
 #include "avx512-32bit-qsort.hpp"
+#include "avx512-64bit-argsort.hpp"
 #include "avx512-64bit-keyvaluesort.hpp"
 #include "avx512-64bit-qsort.hpp"
+#include "avx512-parallel-qsort.hpp"
+#include "avx512-radix-sort.hpp"
+#include "avx512-ymm-qsort.hpp"
 #include "cpuinfo.h"
 #include "rand_array.h"
+#include "x86simdsort-internal.h"
+#include "x86simdsort.h"
 #include <gtest/gtest.h>
 #include <vector>
 
+/*
+ * CSR offsets of nsegments segments: mostly shorter than the bitonic
+ * networks, some empty and every 97th one long enough for quicksort
+ */
+std::vector<int64_t> get_segment_offsets(int64_t nsegments)
+{
+    std::vector<int64_t> offsets = {0};
+    for (int64_t ii = 0; ii < nsegments; ++ii) {
+        int64_t len = (ii % 97 == 0) ? 1000 + ii : ii % 150;
+        offsets.push_back(offsets.back() + len);
+    }
+    return offsets;
+}
+
 template <typename T>
 class avx512_sort : public ::testing::Test {
 };
@@ -46,71 +70,1920 @@ TYPED_TEST_P(avx512_sort, test_arrsizes)
     }
 }
 
-REGISTER_TYPED_TEST_SUITE_P(avx512_sort, test_arrsizes);
+TYPED_TEST_P(avx512_sort, test_qselect)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<int64_t> arrsizes;
+        for (int64_t ii = 1; ii < 1024; ++ii) {
+            arrsizes.push_back(ii);
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (size_t ii = 0; ii < arrsizes.size(); ++ii) {
+            /* Random array */
+            arr = get_uniform_rand_array<TypeParam>(arrsizes[ii]);
+            sortedarr = arr;
+            /* Sort with std::sort for comparison */
+            std::sort(sortedarr.begin(), sortedarr.end());
+            int64_t k = get_uniform_rand_array<int64_t>(
+                    1, arrsizes[ii] - 1, 0)[0];
+            avx512_qselect<TypeParam>(arr.data(), k, arr.size());
+            ASSERT_EQ(sortedarr[k], arr[k]);
+            for (int64_t jj = 0; jj < k; ++jj) {
+                ASSERT_LE(arr[jj], arr[k]);
+            }
+            for (int64_t jj = k + 1; jj < arrsizes[ii]; ++jj) {
+                ASSERT_GE(arr[jj], arr[k]);
+            }
+            arr.clear();
+            sortedarr.clear();
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-using Types = testing::Types<uint16_t,
-                             int16_t,
-                             float,
-                             double,
-                             uint32_t,
-                             int32_t,
-                             uint64_t,
-                             int64_t>;
-INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefix, avx512_sort, Types);
+TYPED_TEST_P(avx512_sort, test_partial_qsort)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<int64_t> arrsizes;
+        for (int64_t ii = 1; ii < 1024; ++ii) {
+            arrsizes.push_back(ii);
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (size_t ii = 0; ii < arrsizes.size(); ++ii) {
+            /* Random array */
+            arr = get_uniform_rand_array<TypeParam>(arrsizes[ii]);
+            sortedarr = arr;
+            /* Sort with std::sort for comparison */
+            std::sort(sortedarr.begin(), sortedarr.end());
+            int64_t k = get_uniform_rand_array<int64_t>(
+                    1, arrsizes[ii], 1)[0];
+            /* A k of arrsize or more sorts the whole array */
+            for (int64_t kk : {k, arrsizes[ii], arrsizes[ii] + 5}) {
+                std::vector<TypeParam> arrk = arr;
+                avx512_partial_qsort<TypeParam>(arrk.data(), kk, arrk.size());
+                for (int64_t jj = 0; jj < std::min(kk, arrsizes[ii]); ++jj) {
+                    ASSERT_EQ(sortedarr[jj], arrk[jj]);
+                }
+            }
+            arr.clear();
+            sortedarr.clear();
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-template <typename K, typename V = uint64_t>
-struct sorted_t {
-    K key;
-    K value;
-};
-template <typename K, typename V = uint64_t>
-bool compare(sorted_t<K, V> a, sorted_t<K, V> b)
+TYPED_TEST_P(avx512_sort, test_desc)
 {
-    return a.key == b.key ? a.value < b.value : a.key < b.key;
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (int64_t size = 0; size < 1024; ++size) {
+            /* Random array, then an array with many duplicates */
+            for (int limited = 0; limited < 2; ++limited) {
+                arr = limited ? get_uniform_rand_array<TypeParam>(
+                              size, (TypeParam)10, (TypeParam)0)
+                              : get_uniform_rand_array<TypeParam>(size);
+                sortedarr = arr;
+                std::sort(sortedarr.begin(),
+                          sortedarr.end(),
+                          std::greater<TypeParam>());
+                avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
 }
 
-template <typename K>
-class TestKeyValueSort : public ::testing::Test {
-};
+TYPED_TEST_P(avx512_sort, test_parallel)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<int64_t> arrsizes = {0, 1, 1000, 100000, 1000003};
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (auto size : arrsizes) {
+            /* Random array, then an array with many duplicates */
+            for (int limited = 0; limited < 2; ++limited) {
+                arr = limited ? get_uniform_rand_array<TypeParam>(
+                              size, (TypeParam)10, (TypeParam)0)
+                              : get_uniform_rand_array<TypeParam>(size);
+                sortedarr = arr;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                /* More threads than cores still has to sort correctly */
+                for (int nthreads : {1, 3, 8}) {
+                    std::vector<TypeParam> arr_copy = arr;
+                    avx512_qsort_parallel<TypeParam>(
+                            arr_copy.data(), arr_copy.size(), nthreads);
+                    ASSERT_EQ(sortedarr, arr_copy);
+                    arr_copy = arr;
+                    avx512_sample_sort<TypeParam>(
+                            arr_copy.data(), arr_copy.size(), nthreads);
+                    ASSERT_EQ(sortedarr, arr_copy);
+                }
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-TYPED_TEST_SUITE_P(TestKeyValueSort);
+TYPED_TEST_P(avx512_sort, test_segmented)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<int64_t> offsets = get_segment_offsets(1000);
+        int64_t nsegments = offsets.size() - 1;
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        /* Random array, then an array with many duplicates */
+        for (int limited = 0; limited < 2; ++limited) {
+            arr = limited ? get_uniform_rand_array<TypeParam>(
+                          offsets.back(), (TypeParam)10, (TypeParam)0)
+                          : get_uniform_rand_array<TypeParam>(offsets.back());
+            sortedarr = arr;
+            for (int64_t ii = 0; ii < nsegments; ++ii) {
+                std::sort(sortedarr.begin() + offsets[ii],
+                          sortedarr.begin() + offsets[ii + 1]);
+            }
+            avx512_segmented_sort<TypeParam>(
+                    arr.data(), offsets.data(), nsegments);
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-TYPED_TEST_P(TestKeyValueSort, KeyValueSort)
+TYPED_TEST_P(avx512_sort, test_batched)
 {
-    std::vector<int64_t> keysizes;
-    for (int64_t ii = 0; ii < 1024; ++ii) {
-        keysizes.push_back((TypeParam)ii);
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        std::vector<TypeParam> column;
+        /* Every network size, padded sizes and the fallback to avx512_qsort */
+        for (int32_t arrsize : {1, 2, 3, 4, 7, 8, 13, 16, 31, 32, 33, 100}) {
+            /* Whole registers of arrays, then a partially filled register */
+            for (int64_t batchsize : {64, 333}) {
+                arr = get_uniform_rand_array<TypeParam>(arrsize * batchsize);
+                sortedarr = arr;
+                for (int64_t jj = 0; jj < batchsize; ++jj) {
+                    column.clear();
+                    for (int32_t ii = 0; ii < arrsize; ++ii) {
+                        column.push_back(sortedarr[ii * batchsize + jj]);
+                    }
+                    std::sort(column.begin(), column.end());
+                    for (int32_t ii = 0; ii < arrsize; ++ii) {
+                        sortedarr[ii * batchsize + jj] = column[ii];
+                    }
+                }
+                avx512_batched_sort<TypeParam>(arr.data(), arrsize, batchsize);
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
     }
-    std::vector<TypeParam> keys;
-    std::vector<uint64_t> values;
-    std::vector<sorted_t<TypeParam, uint64_t>> sortedarr;
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-    for (size_t ii = 0; ii < keysizes.size(); ++ii) {
-        /* Random array */
-        keys = get_uniform_rand_array_key<TypeParam>(keysizes[ii]);
-        values = get_uniform_rand_array<uint64_t>(keysizes[ii]);
-        for (size_t i = 0; i < keys.size(); i++) {
-            sorted_t<TypeParam, uint64_t> tmp_s;
-            tmp_s.key = keys[i];
-            tmp_s.value = values[i];
-            sortedarr.emplace_back(tmp_s);
+/*
+ * Concatenation of numruns sorted runs of arr, in the order given by comp
+ */
+template <typename T, typename Compare>
+std::vector<T> get_runs_array(std::vector<T> arr, int numruns, Compare comp)
+{
+    int64_t size = arr.size();
+    for (int run = 0; run < numruns; ++run) {
+        std::sort(arr.begin() + size * run / numruns,
+                  arr.begin() + size * (run + 1) / numruns,
+                  comp);
+    }
+    return arr;
+}
+
+TYPED_TEST_P(avx512_sort, test_presorted)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
         }
-        /* Sort with std::sort for comparison */
-        std::sort(sortedarr.begin(),
-                  sortedarr.end(),
-                  compare<TypeParam, uint64_t>);
-        avx512_qsort_kv<TypeParam>(keys.data(), values.data(), keys.size());
-        for (size_t i = 0; i < keys.size(); i++) {
-            ASSERT_EQ(keys[i], sortedarr[i].key);
-            ASSERT_EQ(values[i], sortedarr[i].value);
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (int64_t size : {2, 3, 17, 33, 64, 65, 100, 1000, 10007}) {
+            for (int limited = 0; limited < 2; ++limited) {
+                std::vector<TypeParam> base = limited
+                        ? get_uniform_rand_array<TypeParam>(
+                                size, (TypeParam)10, (TypeParam)0)
+                        : get_uniform_rand_array<TypeParam>(size);
+                /* Sorted, merged runs, more runs than are merged, reverse */
+                for (int numruns : {1, 2, 5, 8, 9, 50}) {
+                    arr = get_runs_array(base, numruns, std::less<TypeParam>());
+                    sortedarr = base;
+                    std::sort(sortedarr.begin(), sortedarr.end());
+                    avx512_qsort<TypeParam>(arr.data(), arr.size());
+                    ASSERT_EQ(sortedarr, arr);
+                    arr = get_runs_array(
+                            base, numruns, std::greater<TypeParam>());
+                    avx512_qsort<TypeParam>(arr.data(), arr.size());
+                    ASSERT_EQ(sortedarr, arr);
+
+                    std::reverse(sortedarr.begin(), sortedarr.end());
+                    arr = get_runs_array(
+                            base, numruns, std::greater<TypeParam>());
+                    avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+                    ASSERT_EQ(sortedarr, arr);
+                    arr = get_runs_array(base, numruns, std::less<TypeParam>());
+                    avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+                    ASSERT_EQ(sortedarr, arr);
+                }
+            }
         }
-        keys.clear();
-        values.clear();
-        sortedarr.clear();
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
     }
 }
 
-REGISTER_TYPED_TEST_SUITE_P(TestKeyValueSort, KeyValueSort);
+/*
+ * Sizes from X86_SIMD_SORT_FEW_UNIQUE_THRESHOLD up, with at most
+ * X86_SIMD_SORT_FEW_UNIQUE_KEYS distinct values and then one more
+ */
+TYPED_TEST_P(avx512_sort, test_few_unique)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (int64_t size : {1024, 5001, 100003}) {
+            for (int numkeys : {1, 2, 16, 17}) {
+                std::vector<TypeParam> pool
+                        = get_uniform_rand_array<TypeParam>(numkeys);
+                std::vector<TypeParam> base;
+                for (int64_t ii = 0; ii < size; ++ii) {
+                    base.push_back(pool[(ii * 7 + ii / 5) % numkeys]);
+                }
+                sortedarr = base;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                arr = base;
+                avx512_qsort<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+                std::reverse(sortedarr.begin(), sortedarr.end());
+                arr = base;
+                avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
 
-using TypesKv = testing::Types<double, uint64_t, int64_t>;
-INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixKv, TestKeyValueSort, TypesKv);
\ No newline at end of file
+/*
+ * avx512_qsort_parallel and avx512_sample_sort make the same checks as
+ * avx512_qsort before going parallel: sorted runs, reversed runs and few
+ * unique values, large enough for both to use every thread
+ */
+TYPED_TEST_P(avx512_sort, test_parallel_structured)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        const int64_t size = 1000003;
+        std::vector<TypeParam> base = get_uniform_rand_array<TypeParam>(size);
+        std::vector<TypeParam> pool = get_uniform_rand_array<TypeParam>(16);
+        std::vector<std::vector<TypeParam>> arrs
+                = {get_runs_array(base, 1, std::less<TypeParam>()),
+                   get_runs_array(base, 5, std::greater<TypeParam>()),
+                   std::vector<TypeParam>()};
+        for (int64_t ii = 0; ii < size; ++ii) {
+            arrs[2].push_back(pool[(ii * 7 + ii / 5) % 16]);
+        }
+        for (const std::vector<TypeParam> &arr : arrs) {
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            for (int nthreads : {1, 3}) {
+                std::vector<TypeParam> arr_copy = arr;
+                avx512_qsort_parallel<TypeParam>(
+                        arr_copy.data(), size, nthreads);
+                ASSERT_EQ(sortedarr, arr_copy);
+                arr_copy = arr;
+                avx512_sample_sort<TypeParam>(arr_copy.data(), size, nthreads);
+                ASSERT_EQ(sortedarr, arr_copy);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * Half of the elements are random and the other half repeat a few values with
+ * geometrically decreasing frequency, so that the pivot samples keep hitting
+ * copies of the same values
+ */
+TYPED_TEST_P(avx512_sort, test_duplicates)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        std::vector<TypeParam> pool = get_uniform_rand_array<TypeParam>(64);
+        for (int64_t size : {129, 1000, 10007, 100003}) {
+            std::vector<TypeParam> base
+                    = get_uniform_rand_array<TypeParam>(size);
+            for (int64_t ii = 0; ii < size; ii += 2) {
+                base[ii] = pool[__builtin_ctzll(ii / 2 + 1)];
+            }
+            sortedarr = base;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            arr = base;
+            avx512_qsort<TypeParam>(arr.data(), arr.size());
+            ASSERT_EQ(sortedarr, arr);
+            std::reverse(sortedarr.begin(), sortedarr.end());
+            arr = base;
+            avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * Sawtooth arrays whose period is close to the stride of the pivot samples
+ */
+TYPED_TEST_P(avx512_sort, test_periodic)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> sortedarr;
+        for (int64_t size : {16384, 70001}) {
+            for (int64_t period : {size / 16, size / 8, (int64_t)1000}) {
+                std::vector<TypeParam> base;
+                for (int64_t ii = 0; ii < size; ++ii) {
+                    base.push_back((TypeParam)(ii % period));
+                }
+                sortedarr = base;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                arr = base;
+                avx512_qsort<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+                std::reverse(sortedarr.begin(), sortedarr.end());
+                arr = base;
+                avx512_qsort_desc<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * Calls qsort_*bit_ with no iterations left, so that it goes straight to its
+ * merge sort fallback
+ */
+template <typename vtype, typename T>
+void qsort_out_of_iters(T *arr, int64_t arrsize)
+{
+    if constexpr (sizeof(T) == sizeof(uint16_t)) {
+        qsort_16bit_<vtype>(arr, 0, arrsize - 1, 0);
+    }
+    else if constexpr (sizeof(T) == sizeof(uint32_t)) {
+        qsort_32bit_<vtype>(arr, 0, arrsize - 1, 0);
+    }
+    else {
+        qsort_64bit_<vtype>(arr, 0, arrsize - 1, 0);
+    }
+}
+
+TYPED_TEST_P(avx512_sort, test_merge_sort_fallback)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        for (int64_t size : {1, 100, 128, 129, 1000, 10007}) {
+            std::vector<TypeParam> base
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<TypeParam> sortedarr = base;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            std::vector<TypeParam> arr = base;
+            qsort_out_of_iters<zmm_vector<TypeParam>>(arr.data(), size);
+            ASSERT_EQ(sortedarr, arr);
+            std::reverse(sortedarr.begin(), sortedarr.end());
+            arr = base;
+            qsort_out_of_iters<desc_vector<zmm_vector<TypeParam>>>(arr.data(),
+                                                                   size);
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * The unrolled partition, on sizes around its cutoff and with every number of
+ * registers left over after the blocks of num_unroll registers
+ */
+TYPED_TEST_P(avx512_sort, test_partition_unrolled)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        using vtype = zmm_vector<TypeParam>;
+        constexpr int num_unroll = sizeof(TypeParam) == 2
+                ? X86_SIMD_SORT_UNROLL_16BIT
+                : (sizeof(TypeParam) == 4 ? X86_SIMD_SORT_UNROLL_32BIT
+                                          : X86_SIMD_SORT_UNROLL_64BIT);
+        const int64_t blocksize = num_unroll * vtype::numlanes;
+        for (int64_t size = 2 * blocksize - 3; size < 6 * blocksize + 3;
+             size += 5) {
+            std::vector<TypeParam> arr
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            TypeParam pivot = arr[size / 3];
+            TypeParam smallest = vtype::type_max();
+            TypeParam biggest = vtype::type_min();
+            int64_t pivot_index = partition_avx512_unrolled<vtype, num_unroll>(
+                    arr.data(), 0, size, pivot, &smallest, &biggest);
+            for (int64_t ii = 0; ii < size; ++ii) {
+                ASSERT_EQ(arr[ii] < pivot, ii < pivot_index);
+            }
+            ASSERT_EQ(smallest, sortedarr.front());
+            ASSERT_EQ(biggest, sortedarr.back());
+            std::sort(arr.begin(), arr.end());
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * Sizes below and above X86_SIMD_SORT_SORT_COPY_THRESHOLD, and above the
+ * counting sort threshold of 16-bit arrays. src must not be modified.
+ */
+TYPED_TEST_P(avx512_sort, test_sort_copy)
+{
+    if (cpu_has_avx512bw()) {
+        if ((sizeof(TypeParam) == 2) && (!cpu_has_avx512_vbmi2())) {
+            GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+        }
+        for (int64_t size : {0, 1, 100, 4095, 4096, 10007, 70001}) {
+            /* Random array, then an array with many duplicates */
+            for (int limited = 0; limited < 2; ++limited) {
+                const std::vector<TypeParam> src = limited
+                        ? get_uniform_rand_array<TypeParam>(
+                                size, (TypeParam)10, (TypeParam)0)
+                        : get_uniform_rand_array<TypeParam>(size);
+                std::vector<TypeParam> sortedarr = src;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                std::vector<TypeParam> srccopy = src;
+                std::vector<TypeParam> dst(size);
+                avx512_sort_copy<TypeParam>(src.data(), dst.data(), size);
+                ASSERT_EQ(sortedarr, dst);
+                ASSERT_EQ(srccopy, src);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(avx512_sort,
+                            test_arrsizes,
+                            test_qselect,
+                            test_partial_qsort,
+                            test_desc,
+                            test_parallel,
+                            test_segmented,
+                            test_batched,
+                            test_presorted,
+                            test_few_unique,
+                            test_parallel_structured,
+                            test_duplicates,
+                            test_periodic,
+                            test_merge_sort_fallback,
+                            test_partition_unrolled,
+                            test_sort_copy);
+
+using Types = testing::Types<uint16_t,
+                             int16_t,
+                             float,
+                             double,
+                             uint32_t,
+                             int32_t,
+                             uint64_t,
+                             int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefix, avx512_sort, Types);
+
+/*
+ * NAN's must end up at the end of the array, after the rest of the array
+ * sorted in descending order
+ */
+template <typename T>
+void test_qsort_desc_nan()
+{
+    for (int64_t size = 1; size < 1024; ++size) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        arr[size / 2] = std::numeric_limits<T>::quiet_NaN();
+        arr[size - 1] = std::numeric_limits<T>::quiet_NaN();
+        int64_t nan_count = (size / 2 == size - 1) ? 1 : 2;
+        std::vector<T> sortedarr = arr;
+        std::sort(sortedarr.begin(),
+                  sortedarr.end(),
+                  [](T a, T b) { return std::isnan(b) && !std::isnan(a); });
+        std::sort(sortedarr.begin(),
+                  sortedarr.end() - nan_count,
+                  std::greater<T>());
+        avx512_qsort_desc<T>(arr.data(), size);
+        for (int64_t jj = 0; jj < size - nan_count; ++jj) {
+            ASSERT_EQ(sortedarr[jj], arr[jj]);
+        }
+        for (int64_t jj = size - nan_count; jj < size; ++jj) {
+            ASSERT_TRUE(std::isnan(arr[jj]));
+        }
+    }
+}
+
+/*
+ * The NAN's that the first partition of avx512_sort_copy sends to the left
+ * side must still end up at the end of dst. With these sizes the pivot is
+ * sampled at odd indices only, so the NAN's at even indices do not disable
+ * the fused partition.
+ */
+template <typename T>
+void test_sort_copy_nan()
+{
+    for (int64_t size : {100, 10007, 30000}) {
+        std::vector<T> src = get_uniform_rand_array<T>(size);
+        for (int64_t ii = 0; ii < size; ii += 98) {
+            src[ii] = std::numeric_limits<T>::quiet_NaN();
+        }
+        int64_t nan_count = (size + 97) / 98;
+        std::vector<T> sortedarr;
+        for (T val : src) {
+            if (!std::isnan(val)) { sortedarr.push_back(val); }
+        }
+        std::sort(sortedarr.begin(), sortedarr.end());
+        std::vector<T> dst(size);
+        avx512_sort_copy<T>(src.data(), dst.data(), size);
+        for (int64_t jj = 0; jj < size - nan_count; ++jj) {
+            ASSERT_EQ(sortedarr[jj], dst[jj]);
+        }
+        for (int64_t jj = size - nan_count; jj < size; ++jj) {
+            ASSERT_TRUE(std::isnan(dst[jj]));
+        }
+    }
+}
+
+TEST(avx512_sort, test_sort_copy_nan_float)
+{
+    test_sort_copy_nan<float>();
+}
+
+TEST(avx512_sort, test_sort_copy_nan_double)
+{
+    test_sort_copy_nan<double>();
+}
+
+TEST(avx512_sort, test_desc_nan_float)
+{
+    test_qsort_desc_nan<float>();
+}
+
+TEST(avx512_sort, test_desc_nan_double)
+{
+    test_qsort_desc_nan<double>();
+}
+
+/*
+ * -0.0 and 0.0 compare equal but are different values, the sort must keep
+ * as many of each as there were
+ */
+template <typename T>
+void test_qsort_signed_zeros()
+{
+    std::vector<T> arr;
+    for (int64_t ii = 0; ii < 10000; ++ii) {
+        arr.push_back(ii % 3 == 0 ? (T)-0.0 : (ii % 3 == 1 ? (T)0.0 : (T)1));
+    }
+    avx512_qsort<T>(arr.data(), arr.size());
+    int64_t negative_zeros = 0;
+    for (int64_t ii = 0; ii < 10000; ++ii) {
+        ASSERT_EQ(arr[ii], ii < 6667 ? (T)0 : (T)1);
+        negative_zeros += std::signbit(arr[ii]);
+    }
+    ASSERT_EQ(negative_zeros, 3334);
+}
+
+TEST(avx512_sort, test_signed_zeros_float)
+{
+    test_qsort_signed_zeros<float>();
+}
+
+TEST(avx512_sort, test_signed_zeros_double)
+{
+    test_qsort_signed_zeros<double>();
+}
+
+/*
+ * Sizes at and above X86_SIMD_SORT_COUNTING_SORT_THRESHOLD use the counting
+ * sort
+ */
+template <typename T>
+void test_counting_sort()
+{
+    for (int64_t size : {65535, 65536, 100000, 1000003}) {
+        /* Random array, then an array with many duplicates */
+        for (int limited = 0; limited < 2; ++limited) {
+            std::vector<T> arr = limited
+                    ? get_uniform_rand_array<T>(size, (T)10, (T)0)
+                    : get_uniform_rand_array<T>(size);
+            std::vector<T> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            std::vector<T> arr_desc = arr;
+            avx512_qsort<T>(arr.data(), size);
+            ASSERT_EQ(sortedarr, arr);
+            std::reverse(sortedarr.begin(), sortedarr.end());
+            avx512_qsort_desc<T>(arr_desc.data(), size);
+            ASSERT_EQ(sortedarr, arr_desc);
+        }
+    }
+}
+
+TEST(avx512_sort, test_counting_sort_int16)
+{
+    if (cpu_has_avx512_vbmi2()) { test_counting_sort<int16_t>(); }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+    }
+}
+
+TEST(avx512_sort, test_counting_sort_uint16)
+{
+    if (cpu_has_avx512_vbmi2()) { test_counting_sort<uint16_t>(); }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+    }
+}
+
+/*
+ * Random float16 bit patterns, NAN's included: ascending order replaces the
+ * NAN's with 0xFFFF, descending order keeps them as they are
+ */
+TEST(avx512_sort, test_counting_sort_fp16)
+{
+    if (!cpu_has_avx512_vbmi2()) {
+        GTEST_SKIP() << "Skipping this test, it requires avx512_vbmi2";
+    }
+    for (int64_t size : {65535, 65536, 100000, 1000003}) {
+        std::vector<uint16_t> arr = get_uniform_rand_array<uint16_t>(size);
+        std::vector<uint16_t> nans, sortedarr;
+        for (uint16_t val : arr) {
+            if (is_a_nan(val)) { nans.push_back(val); }
+            else {
+                sortedarr.push_back(val);
+            }
+        }
+        std::sort(sortedarr.begin(),
+                  sortedarr.end(),
+                  comparison_func<zmm_vector<float16>>);
+        std::vector<uint16_t> arr_desc = arr;
+
+        avx512_qsort_fp16(arr.data(), size);
+        std::vector<uint16_t> expected = sortedarr;
+        expected.resize(size, 0xFFFF);
+        ASSERT_EQ(expected, arr);
+
+        avx512_qsort_fp16_desc(arr_desc.data(), size);
+        expected.assign(sortedarr.rbegin(), sortedarr.rend());
+        std::sort(arr_desc.end() - nans.size(), arr_desc.end());
+        std::sort(nans.begin(), nans.end());
+        expected.insert(expected.end(), nans.begin(), nans.end());
+        ASSERT_EQ(expected, arr_desc);
+    }
+}
+
+template <typename K, typename V = uint64_t>
+struct sorted_t {
+    K key;
+    K value;
+};
+template <typename K, typename V = uint64_t>
+bool compare(sorted_t<K, V> a, sorted_t<K, V> b)
+{
+    return a.key == b.key ? a.value < b.value : a.key < b.key;
+}
+
+template <typename K>
+class TestKeyValueSort : public ::testing::Test {
+};
+
+TYPED_TEST_SUITE_P(TestKeyValueSort);
+
+TYPED_TEST_P(TestKeyValueSort, KeyValueSort)
+{
+    std::vector<int64_t> keysizes;
+    for (int64_t ii = 0; ii < 1024; ++ii) {
+        keysizes.push_back((TypeParam)ii);
+    }
+    std::vector<TypeParam> keys;
+    std::vector<uint64_t> values;
+    std::vector<sorted_t<TypeParam, uint64_t>> sortedarr;
+
+    for (size_t ii = 0; ii < keysizes.size(); ++ii) {
+        /* Random array */
+        keys = get_uniform_rand_array_key<TypeParam>(keysizes[ii]);
+        values = get_uniform_rand_array<uint64_t>(keysizes[ii]);
+        for (size_t i = 0; i < keys.size(); i++) {
+            sorted_t<TypeParam, uint64_t> tmp_s;
+            tmp_s.key = keys[i];
+            tmp_s.value = values[i];
+            sortedarr.emplace_back(tmp_s);
+        }
+        /* Sort with std::sort for comparison */
+        std::sort(sortedarr.begin(),
+                  sortedarr.end(),
+                  compare<TypeParam, uint64_t>);
+        avx512_qsort_kv<TypeParam>(keys.data(), values.data(), keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            ASSERT_EQ(keys[i], sortedarr[i].key);
+            ASSERT_EQ(values[i], sortedarr[i].value);
+        }
+        keys.clear();
+        values.clear();
+        sortedarr.clear();
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(TestKeyValueSort, KeyValueSort);
+
+using TypesKv = testing::Types<double, uint64_t, int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixKv, TestKeyValueSort, TypesKv);
+/*
+ * Checks that keys are sorted and that every key is still paired with its
+ * original value
+ */
+template <typename K, typename V>
+void assert_kv_sorted(const std::vector<K> &keys_orig,
+                      const std::vector<V> &values_orig,
+                      const std::vector<K> &keys,
+                      const std::vector<V> &values,
+                      bool descending = false)
+{
+    std::vector<std::pair<K, V>> expected, result;
+    for (size_t jj = 0; jj < keys.size(); ++jj) {
+        expected.emplace_back(keys_orig[jj], values_orig[jj]);
+        result.emplace_back(keys[jj], values[jj]);
+    }
+    for (size_t jj = 1; jj < keys.size(); ++jj) {
+        if (descending) { ASSERT_GE(keys[jj - 1], keys[jj]); }
+        else {
+            ASSERT_LE(keys[jj - 1], keys[jj]);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(result, expected);
+}
+
+template <typename K, typename V>
+void test_kv_sort(void (*sort_kv)(K *, V *, int64_t) = avx512_qsort_kv<K, V>,
+                  bool descending = false)
+{
+    std::vector<K> keys, keys_bckup;
+    std::vector<V> values, values_bckup;
+    for (int64_t size = 0; size < 1024; ++size) {
+        /* Random keys, then keys with duplicates and the largest value */
+        for (int limited = 0; limited < 2; ++limited) {
+            if (limited) {
+                keys = get_uniform_rand_array<K>(size, (K)10, (K)0);
+                for (int64_t jj = 0; jj < size; jj += 3) {
+                    keys[jj] = std::numeric_limits<K>::has_infinity
+                            ? std::numeric_limits<K>::infinity()
+                            : std::numeric_limits<K>::max();
+                }
+            }
+            else {
+                keys = get_uniform_rand_array<K>(size);
+            }
+            values = get_uniform_rand_array<V>(size);
+            keys_bckup = keys;
+            values_bckup = values;
+            sort_kv(keys.data(), values.data(), size);
+            assert_kv_sorted(
+                    keys_bckup, values_bckup, keys, values, descending);
+        }
+    }
+}
+
+/*
+ * Sizes from X86_SIMD_SORT_FEW_UNIQUE_THRESHOLD up, with at most
+ * X86_SIMD_SORT_FEW_UNIQUE_KEYS distinct keys and then one more
+ */
+template <typename K, typename V>
+void test_kv_sort_few_unique(
+        void (*sort_kv)(K *, V *, int64_t) = avx512_qsort_kv<K, V>,
+        bool descending = false)
+{
+    for (int64_t size : {1024, 5001, 100003}) {
+        for (int numkeys : {1, 2, 16, 17}) {
+            std::vector<K> keys
+                    = get_uniform_rand_array<K>(size, (K)(numkeys - 1), (K)0);
+            std::vector<V> values = get_uniform_rand_array<V>(size);
+            std::vector<K> keys_bckup = keys;
+            std::vector<V> values_bckup = values;
+            sort_kv(keys.data(), values.data(), size);
+            assert_kv_sorted(
+                    keys_bckup, values_bckup, keys, values, descending);
+        }
+    }
+}
+
+/*
+ * Calls the key-value qsort_*bit_ with no iterations left, so that it goes
+ * straight to its merge sort fallback. As in qsort_kv_*bit, the largest keys
+ * are moved out of the way first: the key-value networks pad with them.
+ */
+template <typename vtype, typename K, typename V>
+void qsort_kv_out_of_iters(K *keys, V *values, int64_t size)
+{
+    int64_t last = move_max_to_end_of_array<vtype>(keys, values, size);
+    if constexpr (sizeof(K) == sizeof(uint32_t)) {
+        qsort_32bit_<vtype, zmm_vector<uint32_t>>(keys, values, 0, last, 0);
+    }
+    else {
+        qsort_64bit_<vtype, index_type_64bit<V>>(keys, values, 0, last, 0);
+    }
+}
+
+template <typename K>
+class TestKeyValueSort32 : public ::testing::Test {
+};
+
+TYPED_TEST_SUITE_P(TestKeyValueSort32);
+
+TYPED_TEST_P(TestKeyValueSort32, KeyValueSort)
+{
+    if (cpu_has_avx512bw()) {
+        test_kv_sort<TypeParam, uint32_t>();
+        test_kv_sort<TypeParam, int32_t>();
+        test_kv_sort<TypeParam, float>();
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TYPED_TEST_P(TestKeyValueSort32, FewUnique)
+{
+    if (cpu_has_avx512bw()) {
+        test_kv_sort_few_unique<TypeParam, uint32_t>();
+        test_kv_sort_few_unique<TypeParam, float>();
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TYPED_TEST_P(TestKeyValueSort32, MergeSortFallback)
+{
+    if (cpu_has_avx512bw()) {
+        using vtype = zmm_vector<TypeParam>;
+        test_kv_sort<TypeParam, uint32_t>(
+                qsort_kv_out_of_iters<vtype, TypeParam, uint32_t>);
+        test_kv_sort<TypeParam, float>(
+                qsort_kv_out_of_iters<desc_vector<vtype>, TypeParam, float>,
+                true);
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(TestKeyValueSort32,
+                            KeyValueSort,
+                            FewUnique,
+                            MergeSortFallback);
+
+using TypesKv32 = testing::Types<float, uint32_t, int32_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixKv32, TestKeyValueSort32, TypesKv32);
+
+/*
+ * NAN keys must end up at the end of the array, still paired with their
+ * values
+ */
+template <typename K>
+void test_kv_sort_nan()
+{
+    for (int64_t size = 1; size < 1024; ++size) {
+        std::vector<K> keys = get_uniform_rand_array<K>(size);
+        std::vector<uint32_t> values(size);
+        std::iota(values.begin(), values.end(), 0);
+        keys[size / 2] = std::numeric_limits<K>::quiet_NaN();
+        keys[size - 1] = std::numeric_limits<K>::quiet_NaN();
+        std::vector<K> keys_bckup = keys;
+        avx512_qsort_kv<K, uint32_t>(keys.data(), values.data(), size);
+        int64_t nan_count = (size / 2 == size - 1) ? 1 : 2;
+        for (int64_t jj = 0; jj < size; ++jj) {
+            if (jj < size - nan_count - 1) {
+                ASSERT_LE(keys[jj], keys[jj + 1]);
+            }
+            if (jj >= size - nan_count) { ASSERT_TRUE(std::isnan(keys[jj])); }
+            ASSERT_TRUE(keys_bckup[values[jj]] == keys[jj]
+                        || std::isnan(keys[jj]));
+        }
+    }
+}
+
+TEST(TestKeyValueSort32, test_nan_float)
+{
+    if (cpu_has_avx512bw()) {
+        test_kv_sort_nan<float>();
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+template <typename K>
+class TestKeyValueSort64 : public ::testing::Test {
+};
+
+TYPED_TEST_SUITE_P(TestKeyValueSort64);
+
+TYPED_TEST_P(TestKeyValueSort64, KeyValueSort)
+{
+    test_kv_sort<TypeParam, uint64_t>();
+    test_kv_sort<TypeParam, int64_t>();
+    test_kv_sort<TypeParam, double>();
+    test_kv_sort<TypeParam, uint32_t>();
+    test_kv_sort<TypeParam, int32_t>();
+    test_kv_sort<TypeParam, float>();
+}
+
+TYPED_TEST_P(TestKeyValueSort64, KeyValueSortDesc)
+{
+    test_kv_sort<TypeParam, uint64_t>(
+            avx512_qsort_kv_desc<TypeParam, uint64_t>, true);
+    test_kv_sort<TypeParam, int64_t>(
+            avx512_qsort_kv_desc<TypeParam, int64_t>, true);
+    test_kv_sort<TypeParam, double>(avx512_qsort_kv_desc<TypeParam, double>,
+                                    true);
+    test_kv_sort<TypeParam, uint32_t>(
+            avx512_qsort_kv_desc<TypeParam, uint32_t>, true);
+    test_kv_sort<TypeParam, int32_t>(
+            avx512_qsort_kv_desc<TypeParam, int32_t>, true);
+    test_kv_sort<TypeParam, float>(avx512_qsort_kv_desc<TypeParam, float>,
+                                   true);
+}
+
+TYPED_TEST_P(TestKeyValueSort64, FewUnique)
+{
+    test_kv_sort_few_unique<TypeParam, uint64_t>();
+    test_kv_sort_few_unique<TypeParam, uint32_t>();
+    test_kv_sort_few_unique<TypeParam, double>(
+            avx512_qsort_kv_desc<TypeParam, double>, true);
+    test_kv_sort_few_unique<TypeParam, int32_t>(
+            avx512_qsort_kv_desc<TypeParam, int32_t>, true);
+}
+
+TYPED_TEST_P(TestKeyValueSort64, MergeSortFallback)
+{
+    using vtype = zmm_vector<TypeParam>;
+    test_kv_sort<TypeParam, uint64_t>(
+            qsort_kv_out_of_iters<vtype, TypeParam, uint64_t>);
+    test_kv_sort<TypeParam, uint32_t>(
+            qsort_kv_out_of_iters<vtype, TypeParam, uint32_t>);
+    test_kv_sort<TypeParam, double>(
+            qsort_kv_out_of_iters<desc_vector<vtype>, TypeParam, double>,
+            true);
+}
+
+TYPED_TEST_P(TestKeyValueSort64, StableSort)
+{
+    for (int64_t size = 0; size < 1024; ++size) {
+        /* Random keys, then keys with many duplicates */
+        for (int limited = 0; limited < 2; ++limited) {
+            std::vector<TypeParam> keys = limited
+                    ? get_uniform_rand_array<TypeParam>(
+                            size, (TypeParam)10, (TypeParam)0)
+                    : get_uniform_rand_array<TypeParam>(size);
+            std::vector<uint64_t> values(size);
+            std::iota(values.begin(), values.end(), 0);
+            std::vector<TypeParam> keys_bckup = keys;
+            avx512_stable_sort_kv(keys.data(), values.data(), size);
+            for (int64_t jj = 0; jj < size; ++jj) {
+                ASSERT_EQ(keys_bckup[values[jj]], keys[jj]);
+                if (jj == 0) { continue; }
+                ASSERT_LE(keys[jj - 1], keys[jj]);
+                if (keys[jj - 1] == keys[jj]) {
+                    ASSERT_LT(values[jj - 1], values[jj]);
+                }
+            }
+        }
+    }
+}
+
+template <typename K, typename V>
+void test_segmented_sort_kv()
+{
+    std::vector<int64_t> offsets = get_segment_offsets(1000);
+    int64_t nsegments = offsets.size() - 1;
+    /* Random keys, then keys with duplicates and the largest value */
+    for (int limited = 0; limited < 2; ++limited) {
+        std::vector<K> keys;
+        if (limited) {
+            keys = get_uniform_rand_array<K>(offsets.back(), (K)10, (K)0);
+            for (int64_t jj = 0; jj < offsets.back(); jj += 3) {
+                keys[jj] = std::numeric_limits<K>::has_infinity
+                        ? std::numeric_limits<K>::infinity()
+                        : std::numeric_limits<K>::max();
+            }
+        }
+        else {
+            keys = get_uniform_rand_array<K>(offsets.back());
+        }
+        std::vector<V> values = get_uniform_rand_array<V>(offsets.back());
+        std::vector<K> keys_bckup = keys;
+        std::vector<V> values_bckup = values;
+        avx512_segmented_sort_kv(
+                keys.data(), values.data(), offsets.data(), nsegments);
+        for (int64_t ii = 0; ii < nsegments; ++ii) {
+            assert_kv_sorted(
+                    std::vector<K>(keys_bckup.begin() + offsets[ii],
+                                   keys_bckup.begin() + offsets[ii + 1]),
+                    std::vector<V>(values_bckup.begin() + offsets[ii],
+                                   values_bckup.begin() + offsets[ii + 1]),
+                    std::vector<K>(keys.begin() + offsets[ii],
+                                   keys.begin() + offsets[ii + 1]),
+                    std::vector<V>(values.begin() + offsets[ii],
+                                   values.begin() + offsets[ii + 1]));
+        }
+    }
+}
+
+TYPED_TEST_P(TestKeyValueSort64, SegmentedSort)
+{
+    test_segmented_sort_kv<TypeParam, uint64_t>();
+    test_segmented_sort_kv<TypeParam, uint32_t>();
+}
+
+REGISTER_TYPED_TEST_SUITE_P(TestKeyValueSort64,
+                            KeyValueSort,
+                            KeyValueSortDesc,
+                            FewUnique,
+                            MergeSortFallback,
+                            StableSort,
+                            SegmentedSort);
+
+using TypesKv64 = testing::Types<double, uint64_t, int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixKv64, TestKeyValueSort64, TypesKv64);
+
+TEST(TestKeyValueSort64, test_nan_double)
+{
+    test_kv_sort_nan<double>();
+}
+
+template <typename T>
+class TestArgsort : public ::testing::Test {
+};
+TYPED_TEST_SUITE_P(TestArgsort);
+
+/*
+ * Checks that arg is a permutation of [0, arr.size()) which sorts arr
+ */
+template <typename T>
+void assert_argsorted(const std::vector<T> &arr, std::vector<int64_t> &arg)
+{
+    std::vector<T> sortedarr = arr;
+    std::sort(sortedarr.begin(), sortedarr.end());
+    for (size_t jj = 0; jj < arr.size(); ++jj) {
+        ASSERT_EQ(arr[arg[jj]], sortedarr[jj]);
+    }
+    std::sort(arg.begin(), arg.end());
+    for (size_t jj = 0; jj < arg.size(); ++jj) {
+        ASSERT_EQ(arg[jj], (int64_t)jj);
+    }
+}
+
+TYPED_TEST_P(TestArgsort, test_random)
+{
+    if (cpu_has_avx512bw()) {
+        std::vector<TypeParam> arr;
+        std::vector<TypeParam> arr_bckup;
+        std::vector<int64_t> arg;
+        for (int64_t size = 0; size < 1024; ++size) {
+            /* Random array and an array with lots of duplicates */
+            for (int limited = 0; limited < 2; ++limited) {
+                if (limited) {
+                    arr = get_uniform_rand_array<TypeParam>(
+                            size, (TypeParam)10, (TypeParam)0);
+                }
+                else {
+                    arr = get_uniform_rand_array<TypeParam>(size);
+                }
+                arr_bckup = arr;
+                arg.resize(size);
+                avx512_argsort<TypeParam>(arr.data(), arg.data(), size);
+                ASSERT_EQ(arr, arr_bckup);
+                assert_argsorted(arr, arg);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TYPED_TEST_P(TestArgsort, test_max_value)
+{
+    if (cpu_has_avx512bw()) {
+        std::vector<TypeParam> arr;
+        std::vector<int64_t> arg;
+        TypeParam max = std::numeric_limits<TypeParam>::max();
+        if (std::is_floating_point<TypeParam>::value) {
+            max = std::numeric_limits<TypeParam>::infinity();
+        }
+        for (int64_t size = 1; size < 1024; ++size) {
+            /* Every other element is the largest value of the dtype */
+            arr = get_uniform_rand_array<TypeParam>(size, (TypeParam)10, 0);
+            for (int64_t jj = 0; jj < size; jj += 2) {
+                arr[jj] = max;
+            }
+            arg.resize(size);
+            avx512_argsort<TypeParam>(arr.data(), arg.data(), size);
+            assert_argsorted(arr, arg);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(TestArgsort, test_random, test_max_value);
+
+using ArgTypes = testing::
+        Types<float, uint32_t, int32_t, double, uint64_t, int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixArg, TestArgsort, ArgTypes);
+
+template <typename T>
+void test_argsort_nan()
+{
+    if (cpu_has_avx512bw()) {
+        for (int64_t size = 1; size < 1024; ++size) {
+            std::vector<T> arr = get_uniform_rand_array<T>(size);
+            arr[size / 2] = std::numeric_limits<T>::quiet_NaN();
+            arr[size - 1] = std::numeric_limits<T>::quiet_NaN();
+            std::vector<int64_t> arg(size);
+            avx512_argsort<T>(arr.data(), arg.data(), size);
+            int64_t nan_count = (size / 2 == size - 1) ? 1 : 2;
+            for (int64_t jj = 0; jj < size - nan_count - 1; ++jj) {
+                ASSERT_LE(arr[arg[jj]], arr[arg[jj + 1]]);
+            }
+            for (int64_t jj = size - nan_count; jj < size; ++jj) {
+                ASSERT_TRUE(std::isnan(arr[arg[jj]]));
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TEST(TestArgsort, test_nan_float)
+{
+    test_argsort_nan<float>();
+}
+
+TEST(TestArgsort, test_nan_double)
+{
+    test_argsort_nan<double>();
+}
+
+template <typename T>
+class TestRadixSort : public ::testing::Test {
+};
+TYPED_TEST_SUITE_P(TestRadixSort);
+
+/*
+ * Random arrays, with negative values, zeros of both signs and infinities for
+ * float and double, and arrays with many duplicates, where most passes are
+ * skipped
+ */
+template <typename T>
+std::vector<T> get_radix_sort_array(int64_t size, bool limited)
+{
+    std::vector<T> arr = limited
+            ? get_uniform_rand_array<T>(size, (T)10, (T)0)
+            : get_uniform_rand_array<T>(size);
+    if (std::is_floating_point<T>::value) {
+        for (int64_t jj = 0; jj < size; jj += 3) {
+            arr[jj] = -arr[jj];
+        }
+        if (size > 4) {
+            arr[1] = -0.0;
+            arr[2] = std::numeric_limits<T>::infinity();
+            arr[4] = -std::numeric_limits<T>::infinity();
+        }
+    }
+    return arr;
+}
+
+TYPED_TEST_P(TestRadixSort, test_random)
+{
+    if (cpu_has_avx512bw()) {
+        for (int64_t size : {0, 1, 2, 15, 16, 17, 1000, 100003}) {
+            for (int limited = 0; limited < 2; ++limited) {
+                std::vector<TypeParam> arr
+                        = get_radix_sort_array<TypeParam>(size, limited);
+                std::vector<TypeParam> sortedarr = arr;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                avx512_radix_sort<TypeParam>(arr.data(), size);
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * The values are the original positions, so checking them against
+ * std::stable_sort also checks that the sort is stable
+ */
+template <typename K, typename V>
+void test_radix_sort_kv()
+{
+    for (int64_t size : {0, 1, 2, 15, 16, 17, 1000, 100003}) {
+        for (int limited = 0; limited < 2; ++limited) {
+            std::vector<K> keys = get_radix_sort_array<K>(size, limited);
+            std::vector<V> values(size);
+            std::vector<std::pair<K, V>> sortedarr;
+            for (int64_t jj = 0; jj < size; ++jj) {
+                values[jj] = (V)jj;
+                sortedarr.emplace_back(keys[jj], values[jj]);
+            }
+            std::stable_sort(sortedarr.begin(),
+                             sortedarr.end(),
+                             [](std::pair<K, V> a, std::pair<K, V> b) {
+                                 return a.first < b.first;
+                             });
+            avx512_radix_sort_kv<K, V>(keys.data(), values.data(), size);
+            for (int64_t jj = 0; jj < size; ++jj) {
+                ASSERT_EQ(sortedarr[jj].first, keys[jj]);
+                ASSERT_EQ(sortedarr[jj].second, values[jj]);
+            }
+        }
+    }
+}
+
+TYPED_TEST_P(TestRadixSort, test_kv)
+{
+    if (cpu_has_avx512bw()) {
+        test_radix_sort_kv<TypeParam, uint64_t>();
+        test_radix_sort_kv<TypeParam, uint32_t>();
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * Sizes above X86_SIMD_SORT_MSD_THRESHOLD split the array into buckets,
+ * except for the arrays with many duplicates, which all fall in one of the
+ * 65536 bins and go to avx512_qsort directly
+ */
+TYPED_TEST_P(TestRadixSort, test_msd)
+{
+    if (cpu_has_avx512bw()) {
+        for (int64_t size : {1000, 2000003}) {
+            for (int limited = 0; limited < 2; ++limited) {
+                for (int nthreads : {1, 3}) {
+                    std::vector<TypeParam> arr
+                            = get_radix_sort_array<TypeParam>(size, limited);
+                    std::vector<TypeParam> sortedarr = arr;
+                    std::sort(sortedarr.begin(), sortedarr.end());
+                    avx512_msd_qsort<TypeParam>(arr.data(), size, nthreads);
+                    ASSERT_EQ(sortedarr, arr);
+                }
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TYPED_TEST_P(TestRadixSort, test_msd_kv)
+{
+    if (cpu_has_avx512bw()) {
+        for (int64_t size : {1000, 2000003}) {
+            for (int limited = 0; limited < 2; ++limited) {
+                std::vector<TypeParam> keys
+                        = get_radix_sort_array<TypeParam>(size, limited);
+                std::vector<TypeParam> keys_bckup = keys;
+                std::vector<uint32_t> values(size);
+                std::iota(values.begin(), values.end(), 0);
+                std::vector<TypeParam> sortedarr = keys;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                avx512_msd_qsort_kv<TypeParam, uint32_t>(
+                        keys.data(), values.data(), size, 2);
+                ASSERT_EQ(sortedarr, keys);
+                for (int64_t jj = 0; jj < size; ++jj) {
+                    ASSERT_EQ(keys_bckup[values[jj]], keys[jj]);
+                }
+                std::sort(values.begin(), values.end());
+                for (int64_t jj = 0; jj < size; ++jj) {
+                    ASSERT_EQ(values[jj], (uint32_t)jj);
+                }
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+/*
+ * 0 to 2^24 - 1 reversed fills every one of the 256 buckets exactly, with
+ * empty bins left after the last one
+ */
+TYPED_TEST_P(TestRadixSort, test_msd_full_buckets)
+{
+    if (cpu_has_avx512bw()) {
+        const int64_t size = 1 << 24;
+        std::vector<TypeParam> arr(size), sortedarr(size);
+        for (int64_t ii = 0; ii < size; ++ii) {
+            arr[ii] = (TypeParam)(size - 1 - ii);
+            sortedarr[ii] = (TypeParam)ii;
+        }
+        avx512_msd_qsort<TypeParam>(arr.data(), size);
+        ASSERT_EQ(sortedarr, arr);
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(TestRadixSort,
+                            test_random,
+                            test_kv,
+                            test_msd,
+                            test_msd_kv,
+                            test_msd_full_buckets);
+
+using RadixTypes = testing::
+        Types<int32_t, uint32_t, float, int64_t, uint64_t, double>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixRadix, TestRadixSort, RadixTypes);
+
+template <typename T>
+void test_radix_sort_nan()
+{
+    if (cpu_has_avx512bw()) {
+        for (int64_t size = 1; size < 1024; ++size) {
+            std::vector<T> arr = get_radix_sort_array<T>(size, false);
+            arr[size / 2] = std::numeric_limits<T>::quiet_NaN();
+            arr[size - 1] = -std::numeric_limits<T>::quiet_NaN();
+            int64_t nan_count = (size / 2 == size - 1) ? 1 : 2;
+            std::vector<T> sortedarr = arr;
+            std::sort(sortedarr.begin(),
+                      sortedarr.end(),
+                      [](T a, T b) { return std::isnan(b) && !std::isnan(a); });
+            std::sort(sortedarr.begin(), sortedarr.end() - nan_count);
+            avx512_radix_sort<T>(arr.data(), size);
+            for (int64_t jj = 0; jj < size - nan_count; ++jj) {
+                ASSERT_EQ(sortedarr[jj], arr[jj]);
+            }
+            for (int64_t jj = size - nan_count; jj < size; ++jj) {
+                ASSERT_TRUE(std::isnan(arr[jj]));
+            }
+        }
+        /* NAN's are in the last bucket of avx512_msd_qsort */
+        int64_t size = 2000003;
+        std::vector<T> arr = get_radix_sort_array<T>(size, false);
+        for (int64_t jj = 0; jj < size; jj += 1000) {
+            arr[jj] = std::numeric_limits<T>::quiet_NaN();
+        }
+        std::vector<T> sortedarr;
+        std::copy_if(arr.begin(),
+                     arr.end(),
+                     std::back_inserter(sortedarr),
+                     [](T a) { return !std::isnan(a); });
+        std::sort(sortedarr.begin(), sortedarr.end());
+        avx512_msd_qsort<T>(arr.data(), size);
+        for (size_t jj = 0; jj < sortedarr.size(); ++jj) {
+            ASSERT_EQ(sortedarr[jj], arr[jj]);
+        }
+        for (int64_t jj = sortedarr.size(); jj < size; ++jj) {
+            ASSERT_TRUE(std::isnan(arr[jj]));
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512bw";
+    }
+}
+
+TEST(TestRadixSort, test_nan_float)
+{
+    test_radix_sort_nan<float>();
+}
+
+TEST(TestRadixSort, test_nan_double)
+{
+    test_radix_sort_nan<double>();
+}
+
+/*
+ * sort(arr, size) against std::sort, for every size below 1024 and a few
+ * larger ones. Skipped, as requiring isa, unless supported.
+ */
+template <typename T, typename sort_t>
+void test_sort_arrsizes(sort_t sort, bool supported, const char *isa)
+{
+    if (!supported) {
+        GTEST_SKIP() << "Skipping this test, it requires " << isa;
+    }
+    std::vector<T> arr;
+    std::vector<T> sortedarr;
+    for (int64_t size = 0; size < 1024; ++size) {
+        arr = get_uniform_rand_array<T>(size);
+        sortedarr = arr;
+        std::sort(sortedarr.begin(), sortedarr.end());
+        sort(arr.data(), arr.size());
+        ASSERT_EQ(sortedarr, arr);
+    }
+    for (int64_t size : {10007, 100003, 1000003}) {
+        arr = get_uniform_rand_array<T>(size);
+        sortedarr = arr;
+        std::sort(sortedarr.begin(), sortedarr.end());
+        sort(arr.data(), arr.size());
+        ASSERT_EQ(sortedarr, arr);
+    }
+}
+
+/*
+ * select(arr, k, size) with a random k, for every size below 1024. Skipped,
+ * as requiring isa, unless supported.
+ */
+template <typename T, typename select_t>
+void test_select_arrsizes(select_t select, bool supported, const char *isa)
+{
+    if (!supported) {
+        GTEST_SKIP() << "Skipping this test, it requires " << isa;
+    }
+    for (int64_t size = 1; size < 1024; ++size) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        std::vector<T> sortedarr = arr;
+        std::sort(sortedarr.begin(), sortedarr.end());
+        int64_t k = get_uniform_rand_array<int64_t>(1, size - 1, 0)[0];
+        select(arr.data(), k, arr.size());
+        ASSERT_EQ(sortedarr[k], arr[k]);
+        for (int64_t jj = 0; jj < k; ++jj) {
+            ASSERT_LE(arr[jj], arr[k]);
+        }
+        for (int64_t jj = k + 1; jj < size; ++jj) {
+            ASSERT_GE(arr[jj], arr[k]);
+        }
+    }
+}
+
+template <typename T>
+class avx2_sort : public ::testing::Test {
+};
+TYPED_TEST_SUITE_P(avx2_sort);
+
+TYPED_TEST_P(avx2_sort, test_arrsizes)
+{
+    test_sort_arrsizes<TypeParam>(
+            avx2_qsort<TypeParam>, cpu_has_avx2(), "avx2");
+}
+
+TYPED_TEST_P(avx2_sort, test_qselect)
+{
+    test_select_arrsizes<TypeParam>(
+            avx2_qselect<TypeParam>, cpu_has_avx2(), "avx2");
+}
+
+/*
+ * Presorted, reversed, few unique and periodic arrays, which go through
+ * sort_if_presorted_, sort_if_few_unique_ and the three way partition
+ */
+TYPED_TEST_P(avx2_sort, test_structured)
+{
+    if (cpu_has_avx2()) {
+        for (int64_t size : {5001, 70001}) {
+            std::vector<std::vector<TypeParam>> bases;
+            std::vector<TypeParam> base
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::sort(base.begin(), base.end());
+            bases.push_back(base);
+            std::reverse(base.begin(), base.end());
+            bases.push_back(base);
+            for (int numkeys : {2, 16, 17}) {
+                std::vector<TypeParam> pool
+                        = get_uniform_rand_array<TypeParam>(numkeys);
+                base.clear();
+                for (int64_t ii = 0; ii < size; ++ii) {
+                    base.push_back(pool[(ii * 7 + ii / 5) % numkeys]);
+                }
+                bases.push_back(base);
+            }
+            for (int64_t period : {size / 16, (int64_t)1000}) {
+                base.clear();
+                for (int64_t ii = 0; ii < size; ++ii) {
+                    base.push_back((TypeParam)(ii % period));
+                }
+                bases.push_back(base);
+            }
+            for (const std::vector<TypeParam> &arr_base : bases) {
+                std::vector<TypeParam> sortedarr = arr_base;
+                std::sort(sortedarr.begin(), sortedarr.end());
+                std::vector<TypeParam> arr = arr_base;
+                avx2_qsort<TypeParam>(arr.data(), arr.size());
+                ASSERT_EQ(sortedarr, arr);
+            }
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx2";
+    }
+}
+
+/*
+ * qsort_avx2_ with no iterations left goes straight to merge_sort_avx2_
+ */
+TYPED_TEST_P(avx2_sort, test_merge_sort_fallback)
+{
+    if (cpu_has_avx2()) {
+        for (int64_t size : {1, 100, 128, 129, 1000, 10007}) {
+            std::vector<TypeParam> arr
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            qsort_avx2_<avx2_vector<TypeParam>>(arr.data(), 0, size - 1, 0);
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx2";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(avx2_sort,
+                            test_arrsizes,
+                            test_qselect,
+                            test_structured,
+                            test_merge_sort_fallback);
+
+using Avx2Types = testing::
+        Types<float, double, uint32_t, int32_t, uint64_t, int64_t>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixAvx2, avx2_sort, Avx2Types);
+
+/*
+ * sort(arr, size) puts the NAN's at the end of the array, and with
+ * signed_zeros keeps every -0.0 and 0.0 (the min/max networks of the AVX-512
+ * sorts can turn one into the other). Skipped, as requiring isa, unless
+ * supported.
+ */
+template <typename T, typename sort_t>
+void test_nan_sort(sort_t sort,
+                   bool supported,
+                   const char *isa,
+                   bool signed_zeros = true)
+{
+    if (!supported) {
+        GTEST_SKIP() << "Skipping this test, it requires " << isa;
+    }
+    for (int64_t size : {1, 100, 1023, 100003}) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        for (int64_t jj = 0; jj < size; jj += 7) {
+            arr[jj] = std::numeric_limits<T>::quiet_NaN();
+        }
+        for (int64_t jj = 3; jj < size; jj += 11) {
+            arr[jj] = (jj % 2) ? (T)-0.0 : (T)0.0;
+        }
+        std::vector<T> sortedarr;
+        std::copy_if(arr.begin(),
+                     arr.end(),
+                     std::back_inserter(sortedarr),
+                     [](T a) { return !std::isnan(a); });
+        std::sort(sortedarr.begin(), sortedarr.end());
+        auto is_negative_zero = [](T a) { return a == 0 && std::signbit(a); };
+        int64_t negative_zeros
+                = std::count_if(arr.begin(), arr.end(), is_negative_zero);
+        sort(arr.data(), size);
+        for (size_t jj = 0; jj < sortedarr.size(); ++jj) {
+            ASSERT_EQ(sortedarr[jj], arr[jj]);
+        }
+        for (int64_t jj = sortedarr.size(); jj < size; ++jj) {
+            ASSERT_TRUE(std::isnan(arr[jj]));
+        }
+        if (signed_zeros) {
+            ASSERT_EQ(negative_zeros,
+                      std::count_if(arr.begin(), arr.end(), is_negative_zero));
+        }
+    }
+}
+
+TEST(avx2_sort, test_nan_float)
+{
+    test_nan_sort<float>(avx2_qsort<float>, cpu_has_avx2(), "avx2");
+}
+
+TEST(avx2_sort, test_nan_double)
+{
+    test_nan_sort<double>(avx2_qsort<double>, cpu_has_avx2(), "avx2");
+}
+
+template <typename T>
+class avx512_ymm_sort : public ::testing::Test {
+};
+TYPED_TEST_SUITE_P(avx512_ymm_sort);
+
+TYPED_TEST_P(avx512_ymm_sort, test_arrsizes)
+{
+    test_sort_arrsizes<TypeParam>(
+            avx512_ymm_qsort<TypeParam>, cpu_has_avx512vl(), "avx512vl");
+}
+
+TYPED_TEST_P(avx512_ymm_sort, test_qselect)
+{
+    test_select_arrsizes<TypeParam>(
+            avx512_ymm_qselect<TypeParam>, cpu_has_avx512vl(), "avx512vl");
+}
+
+/*
+ * Few unique values go through the eq compares of avx512_ymm_vector
+ */
+TYPED_TEST_P(avx512_ymm_sort, test_few_unique)
+{
+    if (cpu_has_avx512vl()) {
+        for (int numkeys : {1, 2, 16, 17}) {
+            std::vector<TypeParam> pool
+                    = get_uniform_rand_array<TypeParam>(numkeys);
+            std::vector<TypeParam> arr;
+            for (int64_t ii = 0; ii < 70001; ++ii) {
+                arr.push_back(pool[(ii * 7 + ii / 5) % numkeys]);
+            }
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            avx512_ymm_qsort<TypeParam>(arr.data(), arr.size());
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+    else {
+        GTEST_SKIP() << "Skipping this test, it requires avx512vl";
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(avx512_ymm_sort,
+                            test_arrsizes,
+                            test_qselect,
+                            test_few_unique);
+
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixYmm, avx512_ymm_sort, Avx2Types);
+
+/*
+ * avx512_ymm_qselect moves the NAN's to the end before selecting
+ */
+template <typename T>
+void test_avx512_ymm_nan()
+{
+    test_nan_sort<T>(avx512_ymm_qsort<T>, cpu_has_avx512vl(), "avx512vl");
+    if (!cpu_has_avx512vl()) { return; }
+    for (int64_t size : {100, 1023, 100003}) {
+        std::vector<T> arr = get_uniform_rand_array<T>(size);
+        for (int64_t jj = 0; jj < size; jj += 7) {
+            arr[jj] = std::numeric_limits<T>::quiet_NaN();
+        }
+        std::vector<T> sortedarr = arr;
+        avx512_ymm_qsort<T>(sortedarr.data(), size);
+        int64_t k = (size - (size + 6) / 7) / 2;
+        avx512_ymm_qselect<T>(arr.data(), k, size);
+        ASSERT_EQ(sortedarr[k], arr[k]);
+    }
+}
+
+TEST(avx512_ymm_sort, test_nan_float)
+{
+    test_avx512_ymm_nan<float>();
+}
+
+TEST(avx512_ymm_sort, test_nan_double)
+{
+    test_avx512_ymm_nan<double>();
+}
+
+/*
+ * The routines of libx86simdsort: the dispatched ones, and every version of
+ * them that this CPU can run. The 16-bit dtypes have no argsort.
+ */
+template <typename T>
+struct lib_funcs {
+    void (*qsort)(T *, int64_t);
+    void (*select)(T *, int64_t, int64_t);
+    void (*argsort)(const T *, int64_t *, int64_t);
+};
+
+template <typename T>
+std::vector<lib_funcs<T>> get_lib_funcs()
+{
+    std::vector<lib_funcs<T>> funcs;
+    if constexpr (sizeof(T) == 2) {
+        funcs.push_back(
+                {x86simdsort::qsort<T>, x86simdsort::select<T>, nullptr});
+        funcs.push_back(
+                {xss::scalar::qsort<T>, xss::scalar::select<T>, nullptr});
+        if (cpu_has_avx512_vbmi2()) {
+            funcs.push_back({xss::avx512_icl::qsort<T>,
+                             xss::avx512_icl::select<T>,
+                             nullptr});
+        }
+    }
+    else {
+        funcs.push_back({x86simdsort::qsort<T>,
+                         x86simdsort::select<T>,
+                         x86simdsort::argsort<T>});
+        funcs.push_back({xss::scalar::qsort<T>,
+                         xss::scalar::select<T>,
+                         xss::scalar::argsort<T>});
+        if (cpu_has_avx2()) {
+            funcs.push_back(
+                    {xss::avx2::qsort<T>, xss::avx2::select<T>, nullptr});
+        }
+        if (cpu_has_avx512vl()) {
+            funcs.push_back({xss::avx512_ymm::qsort<T>,
+                             xss::avx512_ymm::select<T>,
+                             nullptr});
+        }
+        if (cpu_has_avx512bw()) {
+            funcs.push_back({xss::avx512_skx::qsort<T>,
+                             xss::avx512_skx::select<T>,
+                             xss::avx512_skx::argsort<T>});
+        }
+    }
+    return funcs;
+}
+
+template <typename T>
+class x86simdsort_lib : public ::testing::Test {
+};
+TYPED_TEST_SUITE_P(x86simdsort_lib);
+
+TYPED_TEST_P(x86simdsort_lib, test_qsort)
+{
+    for (const lib_funcs<TypeParam> &funcs : get_lib_funcs<TypeParam>()) {
+        for (int64_t size : {0, 1, 7, 100, 1023, 10007, 100003}) {
+            std::vector<TypeParam> arr
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            funcs.qsort(arr.data(), size);
+            ASSERT_EQ(sortedarr, arr);
+        }
+    }
+}
+
+TYPED_TEST_P(x86simdsort_lib, test_select)
+{
+    for (const lib_funcs<TypeParam> &funcs : get_lib_funcs<TypeParam>()) {
+        for (int64_t size : {1, 7, 100, 1023, 10007}) {
+            std::vector<TypeParam> arr
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<TypeParam> sortedarr = arr;
+            std::sort(sortedarr.begin(), sortedarr.end());
+            int64_t k = get_uniform_rand_array<int64_t>(1, size - 1, 0)[0];
+            funcs.select(arr.data(), k, size);
+            ASSERT_EQ(sortedarr[k], arr[k]);
+            for (int64_t jj = 0; jj < k; ++jj) {
+                ASSERT_LE(arr[jj], arr[k]);
+            }
+            for (int64_t jj = k + 1; jj < size; ++jj) {
+                ASSERT_GE(arr[jj], arr[k]);
+            }
+        }
+    }
+}
+
+TYPED_TEST_P(x86simdsort_lib, test_argsort)
+{
+    for (const lib_funcs<TypeParam> &funcs : get_lib_funcs<TypeParam>()) {
+        if (funcs.argsort == nullptr) { continue; }
+        for (int64_t size : {0, 1, 7, 100, 1023, 10007}) {
+            std::vector<TypeParam> arr
+                    = get_uniform_rand_array<TypeParam>(size);
+            std::vector<int64_t> arg(size);
+            funcs.argsort(arr.data(), arg.data(), size);
+            assert_argsorted(arr, arg);
+        }
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(x86simdsort_lib,
+                            test_qsort,
+                            test_select,
+                            test_argsort);
+
+using LibTypes = testing::Types<int16_t,
+                                uint16_t,
+                                int32_t,
+                                uint32_t,
+                                float,
+                                int64_t,
+                                uint64_t,
+                                double>;
+INSTANTIATE_TYPED_TEST_SUITE_P(TestPrefixLib, x86simdsort_lib, LibTypes);
+
+/*
+ * Every version puts the NAN's at the end
+ */
+template <typename T>
+void test_lib_nan()
+{
+    for (const lib_funcs<T> &funcs : get_lib_funcs<T>()) {
+        test_nan_sort<T>(funcs.qsort, true, "", false);
+        if (funcs.argsort == nullptr) { continue; }
+        /* arr, in the order argsort gives */
+        auto argsort = [&funcs](T *arr, int64_t size) {
+            std::vector<int64_t> arg(size);
+            funcs.argsort(arr, arg.data(), size);
+            std::vector<T> sorted(size);
+            for (int64_t jj = 0; jj < size; ++jj) {
+                sorted[jj] = arr[arg[jj]];
+            }
+            std::copy(sorted.begin(), sorted.end(), arr);
+        };
+        test_nan_sort<T>(argsort, true, "", false);
+    }
+}
+
+TEST(x86simdsort_lib, test_nan_float)
+{
+    test_lib_nan<float>();
+}
+
+TEST(x86simdsort_lib, test_nan_double)
+{
+    test_lib_nan<double>();
+}
+
+TEST(x86simdsort_lib, test_isa)
+{
+    if (std::getenv("X86_SIMD_SORT_ISA") != nullptr) {
+        GTEST_SKIP() << "Skipping this test, X86_SIMD_SORT_ISA is set";
+    }
+    std::string expected = "scalar";
+    if (cpu_has_avx2()) { expected = "avx2"; }
+    if (cpu_has_avx512vl()) { expected = "avx512_ymm"; }
+    if (cpu_has_avx512bw()) { expected = "avx512_skx"; }
+    if (cpu_has_avx512_vbmi2()) { expected = "avx512_icl"; }
+    ASSERT_EQ(expected, x86simdsort::isa());
+}
@@ -15,29 +15,95 @@ cpuid(uint32_t feature, uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d)
             : "a"(feature), "c"(0));
 }
 
-int cpu_has_avx512_vbmi2()
+static inline int cpu_has_avx512_vbmi2()
 {
     uint32_t eax(0), ebx(0), ecx(0), edx(0);
     cpuid(0x07, &eax, &ebx, &ecx, &edx);
     return (ecx >> 6) & 0x1;
 }
 
-int cpu_has_avx512bw()
+static inline int cpu_has_avx2()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x07, &eax, &ebx, &ecx, &edx);
+    return (ebx >> 5) & 0x1;
+}
+
+static inline int cpu_has_avx512bw()
 {
     uint32_t eax(0), ebx(0), ecx(0), edx(0);
     cpuid(0x07, &eax, &ebx, &ecx, &edx);
     return (ebx >> 30) & 0x1;
 }
 
-// TODO:
-//int check_os_supports_avx512()
-//{
-//    uint32_t eax(0), ebx(0), ecx(0), edx(0);
-//    cpuid(0x01, &eax, &ebx, &ecx, &edx);
-//    // XSAVE:
-//    if ((ecx >> 27) & 0x1) {
-//	uint32_t xget_eax, xget_edx, index(0);
-//	__asm__ ("xgetbv" : "=a"(xget_eax), "=d"(xget_edx) : "c" (index))
-//    }
-//
-//}
+static inline int cpu_has_avx512vl()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x07, &eax, &ebx, &ecx, &edx);
+    /* AVX-512F and AVX-512VL */
+    const uint32_t vl = (1u << 16) | (1u << 31);
+    return (ebx & vl) == vl;
+}
+
+static inline int cpu_has_avx512_skx()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x07, &eax, &ebx, &ecx, &edx);
+    /* AVX-512F, AVX-512DQ, AVX-512BW and AVX-512VL */
+    const uint32_t skx = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);
+    return (ebx & skx) == skx;
+}
+
+static inline int cpu_has_bmi2()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x07, &eax, &ebx, &ecx, &edx);
+    return (ebx >> 8) & 0x1;
+}
+
+static inline int cpu_has_fma()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x01, &eax, &ebx, &ecx, &edx);
+    return (ecx >> 12) & 0x1;
+}
+
+static inline int cpu_has_popcnt()
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x01, &eax, &ebx, &ecx, &edx);
+    return (ecx >> 23) & 0x1;
+}
+
+/*
+ * The CPUID bits above only say that the CPU has the instructions. They can
+ * only be used if the OS also saves the registers they need on context
+ * switches, which XCR0 tells: XGETBV is available once the OS has set
+ * CPUID.1:ECX.OSXSAVE.
+ */
+static uint64_t xgetbv0()
+{
+    uint32_t eax(0), edx(0);
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+static int check_os_saves(uint64_t xcr0_bits)
+{
+    uint32_t eax(0), ebx(0), ecx(0), edx(0);
+    cpuid(0x01, &eax, &ebx, &ecx, &edx);
+    if (((ecx >> 27) & 0x1) == 0) { return 0; }
+    return (xgetbv0() & xcr0_bits) == xcr0_bits;
+}
+
+/* XMM and YMM state */
+static inline int check_os_supports_avx()
+{
+    return check_os_saves(0x06);
+}
+
+/* XMM and YMM state, the opmask registers and the ZMM registers */
+static inline int check_os_supports_avx512()
+{
+    return check_os_saves(0xe6);
+}